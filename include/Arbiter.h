@@ -0,0 +1,86 @@
+#ifndef _ARBITER_H
+#define _ARBITER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Merges the control input sources into one wheel and head command per control tick
+ * @remarks The sticks and D-pad are momentary velocity sources, each driving some of the axes.
+ *      Each axis is owned by the highest priority source off neutral on it, so a source
+ *      never fights another over an axis. The knobs latch direct wheel goals, which hold after
+ *      the knob is let go, but only while no velocity source is active: the velocity owns
+ *      the wheels, and taking them drops the latches, so knob and stick goals never alternate.
+ *      Stop clears every demand and latch. One command is resolved per control tick,
+ *      so however many inputs change in a tick, at most one set of goals is sent.
+ */
+namespace Arbiter
+{
+    /**
+     * @brief The velocity sources, in priority order
+     */
+    enum Sources
+    {
+        Source_DPad,        // spin and head, deliberate presses
+        Source_LeftStick,   // translation
+        Source_RightStick,  // 'tractor' spin and forward
+        Source_Count
+    };
+
+    /**
+     * @brief The axes of the command
+     */
+    enum Axes
+    {
+        Axis_X,             // robot velocity x
+        Axis_Y,             // robot velocity y
+        Axis_W,             // robot rotation
+        Axis_Head,          // head goal
+        Axis_Count
+    };
+
+    const uint8_t wheelCount = 3;   // the omni-wheel motors
+
+    /**
+     * @brief The command resolved for a control tick
+     */
+    struct Command
+    {
+        float v[Axis_Count];        // the velocity and head goal
+        bool guided;                // the wheels follow the velocity rather than the goals
+        int8_t goals[wheelCount];   // the latched wheel goals, when not guided
+        bool unlatched;             // the latches were dropped this tick, the knobs should show it
+    };
+
+    /**
+     * @brief Set a source's demand on an axis
+     *
+     * @param source The source
+     * @param axis The axis
+     * @param v The value, 0 for neutral
+     */
+    void Demand(Sources source, Axes axis, float v);
+
+    /**
+     * @brief Latch a wheel goal from a knob
+     *
+     * @param wheel The wheel [0..wheelCount)
+     * @param goal The goal
+     * @return true if latched, false while the velocity owns the wheels
+     */
+    bool Latch(uint8_t wheel, int8_t goal);
+
+    /**
+     * @brief Clear every demand and latch, stopping the wheels and head
+     */
+    void Stop();
+
+    /**
+     * @brief Resolve the command for this control tick
+     *
+     * @param cmd Receives the command
+     * @return true if it differs from the last command resolved
+     */
+    bool Resolve(Command& cmd);
+};
+
+#endif // _ARBITER_H
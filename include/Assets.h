@@ -0,0 +1,56 @@
+#ifndef _ASSETS_H
+#define _ASSETS_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief UI images packed in flash by tools/pack_assets.py and drawn by a streaming decoder
+ * @remarks The images/ BMPs are packed at build time into one blob, embedded in the firmware,
+ *      so there is no SD card or BMP parsing at run time and no RAM held by the images.
+ *      The blob is a header, an index, then the pixels of each image:
+ *          uint32_t magic ('PXA1'), uint16_t count, uint16_t reserved
+ *          count x { char name[12], uint16_t width, uint16_t height, uint32_t offset, uint32_t size }
+ *          RGB565 pixels, top row first, RLE compressed: a control byte below 0x80
+ *          is followed by control+1 literal pixels, otherwise the one pixel following
+ *          repeats control-0x80+2 times.
+ */
+namespace Assets
+{
+    /**
+     * @brief A packed image
+     */
+    struct Image
+    {
+        uint16_t width;         // pixels, zero if not found
+        uint16_t height;
+        const uint8_t* data;    // the compressed pixels
+        uint32_t size;          // bytes of compressed pixels
+    };
+
+    /**
+     * @brief Check the embedded blob
+     *
+     * @return true if the blob is valid
+     */
+    bool Init();
+
+    /**
+     * @brief Find an image by name
+     *
+     * @param name The image file name without extension, ignoring case
+     * @param img Receives the image
+     * @return true if the image was found
+     */
+    bool Find(const char* name, Image& img);
+
+    /**
+     * @brief Draw an image, decoding it straight to the screen in one address window
+     *
+     * @param img The image
+     * @param x The left of the image
+     * @param y The top of the image
+     */
+    void Draw(const Image& img, int16_t x, int16_t y);
+};
+
+#endif // _ASSETS_H
@@ -0,0 +1,48 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief Benchmarks of the input and render hot paths, run by the host tests and at startup of BENCH builds
+ * @remarks Each case drives a hot path with a fixed synthetic sequence of events and measures,
+ *      per event, the CPU cycles spent and the pixels, address windows and bytes sent to the screen
+ *      as counted by the Display. The drawing work is checked on the host against the baselines
+ *      in test/test_bench/baselines.h, the one place it is budgeted; the cycles are only
+ *      measured on the device and checked against the budgets kept in Bench.cpp.
+ *      When a change is meant to move a number, update its budget along with it.
+ */
+namespace Bench
+{
+    const uint16_t eventCount = 200;    // events run for each case
+
+    /**
+     * @brief The work measured for a case
+     */
+    struct Result
+    {
+        uint32_t cycles;    // CPU cycles
+        uint32_t pixels;    // pixels written, 0 without DISPLAY_COUNTS
+        uint32_t windows;   // address windows set, 0 without DISPLAY_COUNTS
+        uint32_t bytes;     // bytes sent to the screen, 0 without DISPLAY_COUNTS
+    };
+
+    /**
+     * @brief Run all the benchmarks, drawing on the page area of the screen
+     *
+     * @return true if every case was within its cycle budget
+     * @remarks Run after Pad::Init, with the robot not yet driven, the control goals are left stopped.
+     */
+    bool Run();
+
+    /**
+     * @brief Run one benchmark case, for checking against the host baselines
+     *
+     * @param name The name of the case, as logged by Run
+     * @param r Receives the work done by its eventCount events
+     * @return true if there is such a case
+     */
+    bool Measure(const char* name, Result& r);
+};
+
+#endif // _BENCH_H
@@ -0,0 +1,54 @@
+#ifndef _BOOT_H
+#define _BOOT_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Sequences the startup, running independent subsystems concurrently and timing each stage
+ * @remarks Stages run either in line on the setup task, like the screen and touchscreen sharing its SPI bus,
+ *      or started on the control core alongside it, like the radio and the I2C and PSX inputs,
+ *      which spend most of their time waiting on their hardware. Join waits for the started stages,
+ *      before anything that uses them. Each stage's start and end are kept as a boot timeline,
+ *      logged at the end of startup and again on the LOG page.
+ */
+namespace Boot
+{
+    typedef void (*stage_fn)();
+
+    const uint8_t stageMax = 16;    // the most stages timed
+
+    /**
+     * @brief Run a stage in line on the calling task
+     *
+     * @param name The stage name, for the timeline
+     * @param func The stage
+     */
+    void Run(const char* name, stage_fn func);
+
+    /**
+     * @brief Start a stage on the control core, concurrently with the calling task
+     *
+     * @param name The stage name, for the timeline
+     * @param func The stage, which must not touch the screen
+     */
+    void Start(const char* name, stage_fn func);
+
+    /**
+     * @brief Wait for the started stages to complete
+     */
+    void Join();
+
+    /**
+     * @brief Mark a point in the timeline, a stage of no length
+     *
+     * @param name The mark name
+     */
+    void Mark(const char* name);
+
+    /**
+     * @brief Log the boot timeline
+     */
+    void Report();
+};
+
+#endif // _BOOT_H
@@ -4,14 +4,10 @@
 #include <Arduino.h>
 #include "Domain.h"
 #include "PSXPad.h"
+#include "Profiles.h"
 
 namespace Controller
 {
-    /**
-     * @brief Serial print interesting values for plotting using the Teleplot VS Code extension
-     */
-    void DoPlot();
-
     /**
      * @brief Activate the UI page
      */
@@ -23,21 +19,50 @@ namespace Controller
     void Deactivate();
 
     /**
-     * @brief Process PSX key activity for the UI page
+     * @brief Process PSX key activity to control the robot
      * 
      * @param btn the PSX button, joystick or knob changed
      * @param x the x (or only) value
      * @param y the (optional) y value
      * @remark only joysticks will have a y value
+     * @remarks Runs in the control task and draws nothing, the ControlMode is published in the State
      */
     void ProcessKey(PadKeys btn, int16_t x, int16_t y);
 
     /**
-     * @brief     Process Property changes (from another remote Domain)
-     * @param     pe pointer to the Entity
-     * @param     pp pointer to the changed Property
+     * @brief Perform periodic processing, once per control tick, to send the arbitrated command
+     * @remarks The keys only post their demands to the Arbiter, the goals are set here
+     */
+    void Loop();
+
+    /**
+     * @brief Process PSX key activity for the UI page, the L1/L2 chart keys
+     * 
+     * @param btn the PSX button, joystick or knob changed
+     * @param x the x (or only) value
+     * @param y the (optional) y value
+     */
+    void ProcessChartKey(PadKeys btn, int16_t x, int16_t y);
+
+    /**
+     * @brief     Process Property changes (from another remote Domain, or the ControlMode)
+     * @param     entity the ID of the Entity
+     * @param     property the ID of the changed Property
+     * @param     v the new value
+     */
+    void ProcessChange(EntityID entity, PropertyID property, int16_t v);
+
+    /**
+     * @brief     Process new History samples, updating the chart for the UI page
+     * @param     tiers bit mask of the History tiers with a new sample
+     */
+    void ProcessHistory(uint8_t tiers);
+
+    /**
+     * @brief Use a control Profile, precomputing the gains and matrix derived from it
+     * @param profile The profile, which must remain valid while in use
      */
-    void ProcessChange(Entity* pe, Property* pp);
+    void SetProfile(const Profile& profile);
 };
 
 #endif // _CONTROLLER_H
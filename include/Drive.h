@@ -0,0 +1,47 @@
+#ifndef _DRIVE_H
+#define _DRIVE_H
+
+#include "PSXPad.h"
+#include "Pad.h"
+#include "Touch.h"
+
+/**
+ * @brief Touchscreen robot control UI page, a fallback for a missing or broken PSX controller
+ * @remarks Two virtual joysticks produce the same PadKeys_leftStick and PadKeys_rightStick
+ *      activity as the PSX sticks, sampled at the control tick rate and smoothed,
+ *      and virtual buttons stand in for the Cross (stop) and Start (mode) buttons.
+ */
+namespace Drive
+{
+    /**
+     * @brief Activate the UI page
+     */
+    void Activate();
+
+    /**
+     * @brief Deactivate the UI page, releasing the sticks
+     */
+    void Deactivate();
+
+    /**
+     * @brief Process touch gestures for the UI page
+     *
+     * @param e The gesture event
+     */
+    void ProcessTouch(const TouchEvent& e);
+
+    /**
+     * @brief Perform periodic processing, once per control tick, to report virtual stick activity
+     *
+     * @param func A callback function to notify the caller of stick and button activity
+     * @remarks Runs in the control task, the sticks are drawn by Render
+     */
+    void Loop(pad_cb func);
+
+    /**
+     * @brief Perform periodic UI processing to move the knobs drawn to the stick deflections
+     */
+    void Render();
+};
+
+#endif // _DRIVE_H
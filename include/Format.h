@@ -0,0 +1,87 @@
+#ifndef _FORMAT_H
+#define _FORMAT_H
+
+#include <Arduino.h>
+#include "Domain.h"
+
+/**
+ * @brief Text for Property values, for the UI pages and the log
+ * @remarks Each Property has a formatter giving its name, its units and its natural width,
+ *      and the names of its values when it is an enum, like the NavLights Animation.
+ *      Numbers are right aligned in their width, as the telemetry columns show them.
+ *      The text for the common [numberMin..numberMax] range in the telemetry width is
+ *      computed at compile time into flash, so rendering a value is a table lookup,
+ *      with no printf anywhere on the render path.
+ */
+namespace Format
+{
+    const uint8_t widthMax = 10;        // the widest text
+    const uint8_t numberWidth = 4;      // the width of the precomputed numbers
+    const int16_t numberMin = -100;     // the range of the precomputed numbers
+    const int16_t numberMax = 100;
+
+    /**
+     * @brief Put a value as right aligned decimal text
+     *
+     * @param v The value
+     * @param buf The buffer to receive width characters and a terminator
+     * @param width The field width, characters beyond are truncated from the left
+     */
+    constexpr void Int(int16_t v, char* buf, uint8_t width)
+    {
+        int32_t n = v < 0 ? -(int32_t)v : v;
+        int i = width;
+        buf[i] = '\0';
+        do
+        {
+            buf[--i] = '0' + n % 10;
+            n /= 10;
+        } while (n != 0 && i > 0);
+        if (v < 0 && i > 0)
+            buf[--i] = '-';
+        while (i > 0)
+            buf[--i] = ' ';
+    }
+
+    /**
+     * @brief Get a value as right aligned decimal text
+     *
+     * @param v The value
+     * @param width The field width, up to widthMax
+     * @param buf Receives the text when it is not precomputed, width characters and a terminator
+     * @return const char* The text, precomputed when it can be
+     */
+    const char* Number(int16_t v, uint8_t width, char* buf);
+
+    /**
+     * @brief Get the text for a Property value
+     *
+     * @param property The ID of the Property
+     * @param v The value
+     * @param width The field width, up to widthMax
+     * @param buf Receives the text when it is not precomputed, width characters and a terminator
+     * @return const char* The name of the value, or the value right aligned in the width
+     */
+    const char* Value(PropertyID property, int16_t v, uint8_t width, char* buf);
+
+    /**
+     * @brief Get the natural width of a Property's values
+     */
+    uint8_t Width(PropertyID property);
+
+    /**
+     * @brief Get the units of a Property, "" for none
+     */
+    const char* Unit(PropertyID property);
+
+    /**
+     * @brief Log a Property value, with its Entity and Property names and units
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the Property
+     * @param v The value
+     */
+    void Log(EntityID entity, PropertyID property, int16_t v);
+};
+
+#endif // _FORMAT_H
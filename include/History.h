@@ -0,0 +1,109 @@
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+#include "PSXPad.h"
+#include "Layout.h"
+
+/**
+ * @brief Fixed-memory rolling store of Property samples, with on-screen charting
+ * @remarks Each tracked Property is sampled at a configurable rate into a raw ring,
+ *      which is downsampled into 1 second and 10 second min/max rings for longer views.
+ */
+namespace History
+{
+    /**
+     * @brief The downsampling tiers, each with its own ring of samples
+     */
+    enum Tiers
+    {
+        Tier_Raw,       // every sample
+        Tier_1s,        // min/max over each second
+        Tier_10s,       // min/max over each 10 seconds
+        Tier_Count
+    };
+
+    /**
+     * @brief The range of values over a sample period
+     */
+    struct Sample
+    {
+        int16_t lo;
+        int16_t hi;
+    };
+
+    const uint8_t seriesCount = 6;  // Goal and RPM for each of the 3 motors
+    const uint8_t rateDefault = 10; // raw samples per second
+
+    /**
+     * @brief Set the raw sampling rate
+     *
+     * @param hz Samples per second [1..50]
+     */
+    void SetRate(uint8_t hz);
+
+    /**
+     * @brief Perform periodic loop() processing to take a sample of the State snapshot when due
+     *
+     * @return uint8_t A bit mask, 1 << Tiers, of the tiers that received a new sample
+     * @remarks Takes one sample a call, call until it returns 0 to catch up the samples due
+     *      while the loop rested
+     */
+    uint8_t Loop();
+
+    /**
+     * @brief Find the series recording an Entity Property
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the Property
+     * @return int The series index or -1 if not recorded
+     */
+    int Find(EntityID entity, PropertyID property);
+
+    /**
+     * @brief Get the number of samples held in a tier
+     *
+     * @param tier The tier
+     */
+    uint16_t Count(Tiers tier);
+
+    /**
+     * @brief Get a sample
+     *
+     * @param series The series index
+     * @param tier The tier
+     * @param age The number of samples back from the newest (0)
+     * @return Sample The sample
+     */
+    Sample Get(uint8_t series, Tiers tier, uint16_t age);
+
+    /**
+     * @brief A chart of two series, such as Goal vs RPM, drawn as a sweeping trace
+     */
+    struct Chart
+    {
+        Layout::Rect rect;      // the screen area, including its margin
+        int16_t min;            // low end of the value range
+        int16_t max;            // high end of the value range
+        uint8_t series[2];      // the series plotted
+        uint16_t colors[2];     // the colors for the series
+        Tiers tier;             // the tier plotted
+        int16_t column;         // the next column to draw
+        int16_t plotY[2];       // the last y plotted for each series
+    };
+
+    /**
+     * @brief Fully draw a chart from the stored history
+     *
+     * @param chart The chart
+     */
+    void DrawChart(Chart& chart);
+
+    /**
+     * @brief Draw the newest sample on a chart, touching only its column and the gap ahead
+     *
+     * @param chart The chart
+     */
+    void UpdateChart(Chart& chart);
+};
+
+#endif // _HISTORY_H
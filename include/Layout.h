@@ -0,0 +1,157 @@
+#ifndef _LAYOUT_H
+#define _LAYOUT_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief Declarative layout and incremental drawing of telemetry widgets
+ * @remarks Widgets are placed on a grid of character-sized columns and fixed height rows,
+ *      so their screen rectangles are fully determined at compile time.
+ *      Each kind of widget keeps just enough state to redraw only the pixels that change.
+ */
+namespace Layout
+{
+    const int16_t gridTop = 32;     // y of the first grid row
+    const int16_t rowHeight = 27;   // grid row pitch
+    const int8_t margin = 3;        // border around widget contents
+    const uint8_t textMax = 10;     // the most characters in a text widget
+
+    const uint16_t panelColor = RGBto565(54, 54, 54);   // widget background
+
+    /**
+     * @brief The kinds of widget
+     */
+    enum WidgetKind
+    {
+        Widget_Label,       // fixed text
+        Widget_Text,        // numeric Property value as text
+        Widget_Bar,         // horizontal bar gauge, from zero (or min) to the value
+        Widget_Sparkline,   // sweeping trace of the recent values
+        Widget_Lamp,        // status lamp lit when the value magnitude reaches min
+    };
+
+    /**
+     * @brief The declarative description of a widget
+     */
+    struct Widget
+    {
+        WidgetKind kind;        // the kind of widget
+        uint8_t col;            // grid column of the top left, in characters
+        uint8_t row;            // grid row of the top left
+        uint8_t cols;           // grid columns spanned (characters for text)
+        uint8_t rows;           // grid rows spanned
+        uint16_t color;         // foreground color
+        EntityID entity;        // the ID of an Entity to display (unused by labels)
+        PropertyID property;    // the ID of a Property on the Entity to display (unused by labels)
+        int16_t min;            // low end of the value range
+        int16_t max;            // high end of the value range
+        const char* label;      // text of a label
+    };
+
+    /**
+     * @brief A screen rectangle
+     */
+    struct Rect
+    {
+        int16_t x;
+        int16_t y;
+        int16_t w;
+        int16_t h;
+    };
+
+    /**
+     * @brief Compute the screen rectangle of a widget from its grid placement
+     *
+     * @param w The widget
+     * @return Rect The rectangle covered, including its margin
+     */
+    constexpr Rect Place(const Widget& w)
+    {
+        return Rect
+        {
+            (int16_t)(w.col * charWidth - margin),
+            (int16_t)(gridTop + w.row * rowHeight - margin),
+            (int16_t)(w.cols * charWidth + margin * 2),
+            (int16_t)((w.rows - 1) * rowHeight + charHeight + margin * 2),
+        };
+    }
+
+    /**
+     * @brief The drawing state of a widget, remembering what is on the screen
+     */
+    struct WidgetState
+    {
+        bool drawn;             // the widget has been fully drawn
+        int16_t value;          // the last value drawn
+        int16_t lo, hi;         // bar: the filled pixel span
+        int16_t column;         // sparkline: the next column to draw
+        int16_t plotY;          // sparkline: the last y plotted
+        char text[textMax + 1]; // text: the characters drawn
+        int8_t node;            // the Scene node it occupies
+    };
+
+    /**
+     * @brief Fully draw a widget
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param s The widget state
+     * @param v The value to display (unused by labels)
+     */
+    void Draw(const Widget& w, const Rect& r, WidgetState& s, int16_t v);
+
+    /**
+     * @brief Draw a new value, touching only the pixels that change
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param s The widget state
+     * @param v The value to display
+     * @remarks Falls back to Draw if the widget has not been drawn
+     */
+    void Update(const Widget& w, const Rect& r, WidgetState& s, int16_t v);
+
+    /**
+     * @brief Draw label text, touching only the characters that change
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param s The widget state
+     * @param text The text to display
+     * @param color The text color
+     * @param force true to redraw all the characters, as for a color change
+     */
+    void DrawText(const Widget& w, const Rect& r, WidgetState& s, const char* text, uint16_t color, bool force);
+
+    /**
+     * @brief Compute the Scene key for the content of a widget showing a value
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param v The value displayed (unused by labels)
+     * @return uint32_t The key, unique for sparklines as they never match what is on the screen
+     */
+    uint32_t Key(const Widget& w, const Rect& r, int16_t v);
+
+    /**
+     * @brief Place a widget in the Scene being presented, between Scene::Begin and Scene::End
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param s The widget state
+     * @param v The value to display (unused by labels)
+     */
+    void Present(const Widget& w, const Rect& r, WidgetState& s, int16_t v);
+
+    /**
+     * @brief Show a presented widget after Scene::End, drawing it only if the screen differs
+     *
+     * @param w The widget
+     * @param r The widget rectangle
+     * @param s The widget state
+     * @param v The value to display (unused by labels)
+     */
+    void Show(const Widget& w, const Rect& r, WidgetState& s, int16_t v);
+};
+
+#endif // _LAYOUT_H
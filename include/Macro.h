@@ -0,0 +1,52 @@
+#ifndef _MACRO_H
+#define _MACRO_H
+
+#include "PSXPad.h"
+#include "Pad.h"
+
+/**
+ * @brief Recording and timed playback of control sequences, for repeatable drive train tests
+ * @remarks Square starts and stops recording the control key activity passed to Controller::ProcessKey,
+ *      Circle starts and stops playing it back. Cross, which stops the motors, also stops playback.
+ *      Events are stored in RAM as compact deltas: varint milliseconds since the previous event,
+ *      the key, and the zigzag varint values (y only for the sticks).
+ *      Playback is timed against the start of playback, so timing does not drift with UI load.
+ *      The control tick replays the events come due through the same Controller path as live input,
+ *      so live and replayed input are sent alike, and as live input is only seen once a tick,
+ *      replay timing is quantized to the control tick just the same.
+ *      Live control input is ignored during playback, keeping the test reproducible.
+ *      Stopping playback, or reaching its end, stops the motors.
+ */
+namespace Macro
+{
+    const uint16_t bufferMax = 8192;    // bytes of recorded events
+
+    /**
+     * @brief Process PSX key activity, recording it or starting and stopping recording and playback
+     *
+     * @param btn the PSX button, joystick or knob changed
+     * @param x the x (or only) value
+     * @param y the (optional) y value
+     * @return true if the key should still go on to the Controller
+     */
+    bool ProcessKey(PadKeys btn, int16_t x, int16_t y);
+
+    /**
+     * @brief Perform periodic processing, once per control tick, to replay the events come due
+     *
+     * @param func A callback function to replay the events to
+     */
+    void Loop(pad_cb func);
+
+    /**
+     * @brief Determine if a sequence is playing
+     */
+    bool Playing();
+
+    /**
+     * @brief Determine if a sequence is being recorded
+     */
+    bool Recording();
+};
+
+#endif // _MACRO_H
@@ -4,7 +4,6 @@
 #include <Adafruit_GFX.h>         // Core graphics library
 #include <Adafruit_HX8357.h>      // Hardware-specific library
 #include <Adafruit_STMPE610.h>
-#include <Adafruit_ImageReader.h> // Image-reading functions
 #include "Domain.h"
 
 /**
@@ -15,27 +14,60 @@
  * @param b Blue value [0..255]
  * @return uint16_t 16-bit value with RGB packed as 5 bits red, 6 bits green and 5 bits blue
  */
-inline uint16_t RGBto565(uint8_t r, uint8_t g, uint8_t b)
+constexpr uint16_t RGBto565(uint8_t r, uint8_t g, uint8_t b)
 {
     return ((r / 8) << 11) | ((g / 4) << 5) | (b / 8);
 }
 
-// serial print a value and its name(s) for the VS Code Teleplot extension to recognize and plot
-#define plot(name1, name2, v) do {} while(0)
-//#define plot(name1, name2, v) Serial.printf(">%s %s:%i\r\n", name1, name2, (int)(v))
-
 const byte STMPE_CS = 32;   // touchscreen I2C chip select pin
+const byte STMPE_IRQ = 4;   // touchscreen interrupt pin (A5, jumpered to the FeatherWing touch IRQ pad)
 const byte TFT_CS = 15;     // TFT screen I2C chip select pin
 const byte TFT_DC = 33;     // TFT screen data control pin
 const byte SD_CS = 14;      // SD card I2C chip select pin
 
-const byte PSX_DAT = 37;    // PSX data SPI data input pin (input only pin!)
+const byte PSX_DAT = 37;    // PSX data SPI data input pin (input only pin, no internal pull-up, needs an external one!)
 const byte PSX_CMD = 27;    // PSX data SPI command output pin
 const byte PSX_CLK = 13;    // PSX data SPI clock output pin
 const byte PSX_ATT = 12;    // PSX data SPI attention (CS) output pin
 
-extern Adafruit_ImageReader reader;
-extern Adafruit_HX8357 tft;
+// define to run the hot path benchmarks at startup, see Bench.h
+//#define BENCH
+
+#if defined(BENCH) || !defined(ARDUINO)
+// the Display counts the work sent to the screen, for the benchmarks of the host and BENCH builds
+#define DISPLAY_COUNTS
+#endif
+
+/**
+ * @brief The HX8357 screen, counting the work sent to it when DISPLAY_COUNTS is defined
+ * @remarks Every Adafruit_SPITFT drawing primitive addresses a window and then streams its pixels,
+ *      so the windows and their areas count the SPI transactions and the pixels written.
+ *      Each window also costs about 11 bytes of commands on top of 2 bytes per pixel.
+ *      The production firmware draws without counting.
+ */
+class Display : public Adafruit_HX8357
+{
+public:
+    Display(int8_t cs, int8_t dc) : Adafruit_HX8357(cs, dc) {}
+
+#ifdef DISPLAY_COUNTS
+    static const uint8_t windowBytes = 11;     // the commands and arguments addressing a window
+
+    void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) override
+    {
+        windows++;
+        pixels += (uint32_t)w * h;
+        bytes += windowBytes + 2 * (uint32_t)w * h;
+        Adafruit_HX8357::setAddrWindow(x, y, w, h);
+    }
+
+    uint32_t windows = 0;   // address windows set
+    uint32_t pixels = 0;    // pixels addressed
+    uint32_t bytes = 0;     // bytes of the windows and their pixels
+#endif
+};
+
+extern Display tft;
 extern Adafruit_STMPE610 ts;
 
 // display characteristics
@@ -45,7 +77,7 @@ const uint8_t charWidth = 12;
 const uint8_t charHeight = 16;
 
 // menu bar characteristics
-const int8_t menuItems = 4;
+const int8_t menuItems = 5;
 const uint16_t menuItemWidth = tftWidth / menuItems;
 const uint16_t menuItemHeight = charHeight + 12;
 const int16_t menuY = tftHeight - menuItemHeight;
@@ -2,6 +2,11 @@
 #define _PAD_H
 
 #include "PSXPad.h"
+#include "Profiles.h"
+
+// define to exchange bytes with the PSX controller through an SPI peripheral
+// otherwise the IO pins are bit-banged by the CPU
+#define PSX_SPI
 
 /**
   * @brief     Callback function for processing button/joystick/knob changes
@@ -32,6 +37,12 @@ namespace Pad
      * @param v The value to set
      */
     void SetKnobValue(PadKeys btn, int16_t v);
+    /**
+     * @brief Use a control Profile, precomputing the stick lookup table and knob scaling
+     * 
+     * @param profile The profile
+     */
+    void SetProfile(const Profile& profile);
 };
 
 #endif // _PAD_H
@@ -0,0 +1,76 @@
+#ifndef _POWER_H
+#define _POWER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Adapts the polling rate and power draw to the input activity, for the battery
+ * @remarks Active, the control task ticks at 20 msec with the CPU at full speed.
+ *      After a few seconds with no input it steps down to Idle, ticking at 100 msec with the CPU slowed.
+ *      After a minute idle, with the wheels stopped, it steps down to Sleep, light sleeping between
+ *      slow ticks. Any input returns it to Active at once: the PSX pad and knobs on the next tick,
+ *      and the touchscreen by its interrupt, which also wakes the light sleep.
+ *      The UI loop rests between the control ticks rather than spinning.
+ *      The time in each mode is kept, with an estimate of the current drawn.
+ */
+namespace Power
+{
+    /**
+     * @brief The power modes, in order of decreasing draw
+     */
+    enum Modes
+    {
+        Mode_Active,    // inputs active, full rate
+        Mode_Idle,      // no input for a while, slow polling
+        Mode_Sleep,     // no input for long, stopped, light sleep between polls
+        Mode_Count
+    };
+
+    /**
+     * @brief Set up the wakeup sources
+     * @remarks Call from the UI task, which the touchscreen interrupt wakes
+     */
+    void Init();
+
+    /**
+     * @brief Note input activity, returning to the Active mode
+     * @remarks Call from either task
+     */
+    void Activity();
+
+    /**
+     * @brief Wake the UI task, from an interrupt handler
+     */
+    void IRAM_ATTR WakeFromISR();
+
+    /**
+     * @brief Wait for the next control tick, in the control task
+     *
+     * @param wake The tick count of the last wake, as for vTaskDelayUntil
+     * @return uint16_t The tick period in msec
+     * @remarks Steps the mode down as the inputs stay idle
+     */
+    uint16_t Wait(TickType_t& wake);
+
+    /**
+     * @brief Notify the UI task that a control tick has published its changes
+     */
+    void Ticked();
+
+    /**
+     * @brief Rest the UI task until the next control tick, or an interrupt
+     */
+    void Rest();
+
+    /**
+     * @brief Get the current mode
+     */
+    Modes Mode();
+
+    /**
+     * @brief Log the time in each mode and the estimated current
+     */
+    void Report();
+};
+
+#endif // _POWER_H
@@ -0,0 +1,82 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief Loop-time profiling using the CPU cycle counter, with a live UI page
+ * @remarks Each second the accumulated section times, loop period histogram
+ *      and control tick jitter are snapshot for display and the accumulators restart.
+ *      Sections are timed on both cores, the control task and the UI loop.
+ *      Power steps the CPU clock, so cycles are converted to time as they are added,
+ *      and a power mode change closes the window early, so a snapshot never mixes modes.
+ */
+namespace Profiler
+{
+    /**
+     * @brief The subsystems of loop() processing that are timed
+     */
+    enum Sections
+    {
+        Section_Touch,      // touchscreen polling
+        Section_Pad,        // control task: Pad::Loop including the control responses
+        Section_Sync,       // control task: Sync::Flush
+        Section_History,    // History sampling and charting
+        Section_Changes,    // control task: VirtualBot.ProcessChanges and publishing the State
+        Section_Trace,      // Trace sampling
+        Section_Loop,       // the whole of the UI loop(), including drawing
+        Section_Count
+    };
+
+    const uint8_t binCount = 8;     // loop period histogram bins
+
+    /**
+     * @brief Add time spent in a section
+     *
+     * @param section The section
+     * @param cycles The CPU cycles spent, at the current clock
+     */
+    void Add(Sections section, uint32_t cycles);
+
+    /**
+     * @brief Times a section from construction to destruction
+     */
+    class Scope
+    {
+    public:
+        Scope(Sections section) : section(section), start(ESP.getCycleCount()) {}
+        ~Scope() { Add(section, ESP.getCycleCount() - start); }
+    private:
+        Sections section;
+        uint32_t start;
+    };
+
+    /**
+     * @brief Mark the start of loop(), recording the loop period
+     */
+    void LoopStart();
+
+    /**
+     * @brief Mark the start of a control tick, recording its jitter and tracing the time in each section over the last tick
+     *
+     * @param period The intended tick period in msec
+     */
+    void Tick(uint16_t period);
+
+    /**
+     * @brief Perform periodic loop() processing to snapshot the statistics and update the UI page
+     */
+    void Loop();
+
+    /**
+     * @brief Activate the UI page
+     */
+    void Activate();
+
+    /**
+     * @brief Deactivate the UI page
+     */
+    void Deactivate();
+};
+
+#endif // _PROFILER_H
@@ -0,0 +1,100 @@
+#ifndef _PROFILES_H
+#define _PROFILES_H
+
+#include "PSXPad.h"
+
+const uint8_t profileNameMax = 11;  // the most characters in a Profile name
+const uint8_t knobCount = 4;        // the controller knobs
+
+/**
+ * @brief A named set of control parameters
+ * @remarks The factors were designed using the custom OmniCtrl program to limit motor RPMs to 100.
+ *      Stored as is, so the layout is versioned by Profiles::version.
+ */
+struct Profile
+{
+    char name[profileNameMax + 1];
+    // range factor for each of the ControlModes, in order
+    float modeFactors[3];
+    // 'translate' mode multiplier for arbitrary X & Y stick values [-100..100],
+    //      converting to actual bot X & Y translation speeds (mm/sec)
+    float factorTrans;
+    // 'tractor' mode multiplier for arbitrary X stick values [-100..100] controlling spin,
+    //      converting to actual rotation speed (radians/sec)
+    float factorSpinT;
+    // 'spin' mode multiplier for arbitrary button values [0..255],
+    //      converting to actual rotation speed (radians/sec)
+    float factorSpin;
+    // the kinematic matrix, multiplied by the robot velocity and spin vector to produce the wheel rotation vector
+    float M[3][3];
+    // joystick deadzone, out of the [-127..127] raw stick range
+    int16_t deadzone;
+    // the value range reported for each knob
+    int16_t knobMin[knobCount];
+    int16_t knobMax[knobCount];
+};
+
+/**
+ * @brief Named control profiles, persisted in NVS, and switching between them
+ * @remarks Selecting a Profile has the Controller and Pad precompute what they derive from it,
+ *      so nothing is computed from the parameters per event and nothing is allocated.
+ *      Host builds, without ARDUINO, store the profiles in a file instead.
+ */
+namespace Profiles
+{
+    const uint8_t profileMax = 4;   // the most profiles stored
+    const uint8_t version = 1;      // the Profile layout stored
+    const uint16_t saveDelay = 2000;    // msec a selection settles before it is stored, so cycling through them writes once
+
+    /**
+     * @brief Load the profiles, or the built-in defaults, and select the last one active
+     */
+    void Init();
+
+    /**
+     * @brief Get the number of profiles
+     */
+    uint8_t Count();
+
+    /**
+     * @brief Get a profile
+     *
+     * @param index The profile index [0..Count)
+     */
+    const Profile& Get(uint8_t index);
+
+    /**
+     * @brief Get the index of the active profile
+     */
+    uint8_t Active();
+
+    /**
+     * @brief Select the active profile, applying it, to be remembered for the next boot by Save
+     *
+     * @param index The profile index [0..Count)
+     * @remarks Called from the control task, which an NVS write would stall with the flash cache off
+     */
+    void Select(uint8_t index);
+
+    /**
+     * @brief Store the selection once it has settled for saveDelay
+     * @remarks Call from the UI loop
+     */
+    void Save();
+
+    /**
+     * @brief Replace a profile, storing it and applying it if active
+     *
+     * @param index The profile index [0..Count]; Count adds a profile if there is room
+     * @param profile The new parameters
+     * @return true if stored
+     */
+    bool Store(uint8_t index, const Profile& profile);
+
+    /**
+     * @brief Restore the built-in default profiles
+     */
+    void Reset();
+};
+
+#endif // _PROFILES_H
@@ -0,0 +1,101 @@
+#ifndef _PSXSPI_H
+#define _PSXSPI_H
+
+#include <Arduino.h>
+#include <PsxController.h>
+#include <driver/spi_master.h>
+
+/**
+ * @brief PsxController transport on an ESP32 SPI peripheral, in place of PsxControllerBitBang
+ * @remarks The PSX protocol is SPI mode 3, LSB first, with the attention line as chip select.
+ *      The PsxController base class keeps the whole protocol (polling, config mode, analog frames)
+ *      and parses every reply, this class only moves the bytes, in the SPI peripheral
+ *      rather than the CPU toggling every bit.
+ *
+ *      The poll is sent by StartRead as one DMA transaction of the whole 21 byte analog frame,
+ *      with attention raised again by the transaction's end of transfer callback,
+ *      and FinishRead hands the frame to the base class's read on the next control tick,
+ *      so the CPU spends neither the bit times nor the gaps between bytes waiting on it.
+ *      The bytes of a frame follow each other without the base class's INTER_CMD_BYTE_DELAY,
+ *      which at the DualShock's 250 kHz clock it keeps up with; lower clockHz for a slower pad.
+ *      The config mode exchanges, rare and short, still go a byte at a time through begin and
+ *      the base class, each byte waiting for the pad's ACK pulse when the ACK pin is wired,
+ *      otherwise with the base class's gap between bytes.
+ *
+ *      The data line is open collector and needs an external pull-up, 1k to 10k to 3.3V:
+ *      on GPIO34-39, as PSX_DAT is, the ESP32 has no internal one.
+ */
+class PsxControllerSpi : public PsxController
+{
+public:
+    static const int clockHz = 250000;          // the DualShock's native clock rate
+    static const uint16_t attentionUsec = 16;   // settle time around the attention line
+    static const uint16_t ackTimeoutUsec = 100; // the longest wait for an ACK
+    static const uint8_t frameSize = 21;        // a poll with the sticks and button pressures
+
+    /**
+     * @brief Construct the driver, the bus is set up by begin
+     *
+     * @param host The SPI peripheral, not shared with the screen
+     * @param att The attention (chip select) pin
+     * @param cmd The command (MOSI) pin
+     * @param dat The data (MISO) pin
+     * @param clk The clock pin
+     * @param ack The acknowledge pin, or -1 if not wired
+     */
+    PsxControllerSpi(spi_host_device_t host, int8_t att, int8_t cmd, int8_t dat, int8_t clk, int8_t ack = -1);
+
+    /**
+     * @brief Set up the SPI peripheral, once, and look for the controller
+     *
+     * @return true if the controller answered
+     */
+    boolean begin() override;
+
+    /**
+     * @brief Start a poll of the pad, the whole frame exchanged in the background
+     *
+     * @return true if the poll is under way
+     * @remarks Take the frame with FinishRead before any other exchange with the pad
+     */
+    bool StartRead();
+
+    /**
+     * @brief Take the frame of the poll StartRead started, as read would have read it
+     *
+     * @return true if the pad answered the poll, false if it did not or no poll was started
+     * @remarks Waits for the rest of the frame, if called within its 1 msec
+     */
+    bool FinishRead();
+
+protected:
+    void attention() override;
+    void noAttention() override;
+    byte shiftInOut(const byte out) override;
+    void shiftInOut(const byte* out, byte* in, const byte len) override;
+
+private:
+    /**
+     * @brief Wait for the pad to pulse the ACK line
+     *
+     * @return true if it did before the timeout
+     */
+    bool WaitAck();
+
+    /**
+     * @brief SPI end of transfer callback, releasing attention at the end of a frame
+     */
+    static void FrameDone(spi_transaction_t* t);
+
+    spi_host_device_t host;
+    int8_t att, cmd, dat, clk, ack;
+    spi_device_handle_t device = nullptr;
+    spi_transaction_t frame = {};               // the poll under way, with this as its user
+    bool framing = false;                       // a poll was started and not taken
+    alignas(4) byte frameOut[frameSize + 3];    // the poll, DMA buffers in words
+    alignas(4) byte frameIn[frameSize + 3];     // the pad's answer
+    const byte* replay = nullptr;               // the answer the base class's read is taking its bytes from
+    byte replayed = 0;                          // the bytes it has taken
+};
+
+#endif // _PSXSPI_H
@@ -0,0 +1,105 @@
+#ifndef _SCENE_H
+#define _SCENE_H
+
+#include "PSXPad.h"
+#include "Pad.h"
+#include "Touch.h"
+#include "Layout.h"
+
+/**
+ * @brief A UI page, selected by a menu button
+ * @remarks Handlers a page has no use for are left null.
+ */
+struct Page
+{
+    const char* label;                              // menu button text
+    void (*activate)();                             // present the page and begin showing activity
+    void (*deactivate)();                           // stop showing activity
+    void (*processKey)(PadKeys, int16_t, int16_t);  // PSX controller activity while the page is active
+    void (*processChange)(EntityID, PropertyID, int16_t);   // State changes, of robot Properties the page subscribed to
+    void (*processTouch)(const TouchEvent&);        // gestures above the menu bar, in place of swipes
+};
+
+/**
+ * @brief Retained record of what is on the page area of the screen, for repainting only what differs
+ * @remarks Each page presents itself as a list of nodes, screen rectangles keyed by their content.
+ *      When a page is activated, nodes identical to those already on the screen are kept,
+ *      only the damage rectangles of nodes no longer wanted are cleared to the background,
+ *      and only new or damaged nodes need drawing. Pages that keep the screen current
+ *      incrementally rekey their nodes as they draw, so the record stays true.
+ *
+ *      A page presents in three steps:
+ *          Scene::Begin(background);
+ *          node = Scene::Place(rect, key);  // for each node
+ *          Scene::End();                     // clears the damage
+ *          if (Scene::Dirty(node)) draw it;  // for each node
+ */
+namespace Scene
+{
+    const uint8_t nodeMax = 64;     // the most nodes on the screen
+
+    const Layout::Rect pageRect = { 0, 0, tftWidth, menuY };   // the page area, above the menu bar
+
+    /**
+     * @brief Begin presenting a page
+     *
+     * @param background The color of the page background
+     */
+    void Begin(uint16_t background);
+
+    /**
+     * @brief Add a node to the page being presented
+     *
+     * @param r The screen rectangle it covers
+     * @param key Identifies the content, equal keys over equal rectangles are the same pixels
+     * @return int The node index, or -1 if there are too many nodes
+     */
+    int Place(const Layout::Rect& r, uint32_t key);
+
+    /**
+     * @brief Finish presenting a page, clearing the nodes no longer on the screen
+     */
+    void End();
+
+    /**
+     * @brief Determine if a node must be drawn after End
+     *
+     * @param node The node index from Place
+     * @return true if the node is new or was damaged by clearing
+     */
+    bool Dirty(int node);
+
+    /**
+     * @brief Record new content drawn in a node
+     *
+     * @param node The node index from Place
+     * @param key The key of the new content
+     */
+    void Rekey(int node, uint32_t key);
+
+    /**
+     * @brief Get a key that matches no other content, for nodes that always redraw
+     */
+    uint32_t Unique();
+
+    /**
+     * @brief Present a page that draws the whole page area itself
+     *
+     * @param background The color of the page background
+     */
+    void Opaque(uint16_t background);
+
+    /**
+     * @brief Compute a content key over some bytes, for chaining
+     *
+     * @param key The key so far
+     * @param data The bytes
+     * @param len The byte count
+     * @return uint32_t The new key
+     */
+    uint32_t Hash(uint32_t key, const void* data, size_t len);
+
+    const uint32_t hashSeed = 2166136261u;  // the key before any bytes are hashed
+};
+
+#endif // _SCENE_H
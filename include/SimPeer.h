@@ -0,0 +1,73 @@
+#ifndef _SIMPEER_H
+#define _SIMPEER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief A simulated robot peer for the Sync frames, for testing without the robot, see SYNC_SIM
+ * @remarks The peer keeps its own clock, offset from ours and running fast by a drift,
+ *      and delays each frame each way by a fixed delay plus a random jitter.
+ *      It answers the clock exchanges, and sends the motor RPMs back as the goals it was sent,
+ *      stamped, as telemetry. Like the robot, it only sends the values the controller has subscribed to,
+ *      when they change and no faster than their rate, with all of them in a keyframe.
+ *      It knows the true delays and offset, which it reports for checking the estimates Sync makes of them.
+ */
+namespace SimPeer
+{
+    const uint32_t delayUsec = 3000;        // the least time a frame takes each way
+    const uint32_t jitterUsec = 4000;       // the most random time added to that
+    const int32_t offsetUsec = 250000000;   // how far the peer's clock is ahead of ours
+    const int32_t driftPpb = 40000;         // how fast the peer's clock runs, 40 ppm, until SetDrift
+    const uint16_t turnaroundUsec = 200;    // the peer's time to answer a clock exchange
+    const uint16_t telemetryMsec = 100;     // msec between telemetry frames
+    const uint8_t keyframeInterval = 50;    // telemetry frames between keyframes
+
+    /**
+     * @brief Take a frame sent to the robot
+     *
+     * @param data The frame data
+     * @param len The length of the frame data
+     */
+    void Receive(const uint8_t* data, int len);
+
+    /**
+     * @brief The true clock offset and delays, for checking the estimates of Sync::Clock
+     */
+    struct Truth
+    {
+        int32_t offset;         // usec the peer's micros() is ahead of ours, now
+        int32_t drift;          // parts per billion the peer's clock runs fast
+        uint32_t up;            // usec a frame took to reach the peer, averaged as Sync does
+        uint32_t down;          // usec a frame took to arrive from the peer, averaged
+    };
+
+    /**
+     * @brief Process the frames whose delay has elapsed, passing the answers to Sync::Post
+     * @remarks Call once per control tick
+     */
+    void Loop();
+
+    /**
+     * @brief Change how fast the peer's clock runs, from now on, without a jump in its time
+     *
+     * @param ppb Parts per billion it runs fast, negative for slow
+     */
+    void SetDrift(int32_t ppb);
+
+    /**
+     * @brief Log the true delays and clock offset
+     */
+    void Report();
+
+    /**
+     * @brief Get the true delays and clock offset
+     */
+    Truth GetTruth();
+
+    /**
+     * @brief Get the number of frames the peer has sent back, telemetry and clock exchange answers
+     */
+    uint32_t Frames();
+};
+
+#endif // _SIMPEER_H
@@ -0,0 +1,68 @@
+#ifndef _STATE_H
+#define _STATE_H
+
+#include <Arduino.h>
+#include "Domain.h"
+
+const uint8_t entityCount = EntityID_NavLights + 1;      // EntityIDs, including None
+const uint8_t propertyCount = PropertyID_ControlMode + 1; // PropertyIDs, including None
+
+/**
+ * @brief Control state published by the control task to the UI as a versioned snapshot
+ * @remarks The control task runs on core 0 and the UI renders on core 1.
+ *      The control task sets values in its working copy as they change, and publishes
+ *      the whole copy once per control tick under a sequence lock: the sequence is odd
+ *      while the copy is written. The UI copies the snapshot and retries if the sequence
+ *      was odd or changed meanwhile, so neither side ever waits on a lock,
+ *      and rendering, however slow, cannot stall the control loop.
+ *      Properties with no Entity, like ControlMode, are the controller's own state.
+ */
+namespace State
+{
+    /**
+     * @brief Callback function for a value changed since the last Diff
+     * @param entity the ID of the Entity
+     * @param property the ID of the Property
+     * @param v the new value
+     */
+    typedef void (*change_cb)(EntityID entity, PropertyID property, int16_t v);
+
+    /**
+     * @brief Set a value in the working copy, from the control task
+     *
+     * @param entity The Entity ID
+     * @param property The Property ID
+     * @param v The value
+     */
+    void Set(EntityID entity, PropertyID property, int16_t v);
+
+    /**
+     * @brief Publish the working copy, if changed, from the control task
+     */
+    void Publish();
+
+    /**
+     * @brief Refresh the UI view from the latest snapshot, from the UI
+     *
+     * @return true if there was a newer snapshot
+     */
+    bool Read();
+
+    /**
+     * @brief Get a value from the UI view
+     *
+     * @param entity The Entity ID
+     * @param property The Property ID
+     * @return int16_t The value as of the last Read
+     */
+    int16_t Get(EntityID entity, PropertyID property);
+
+    /**
+     * @brief Report the values of the UI view changed since the last Diff
+     *
+     * @param func A callback function to notify the caller of each changed value
+     */
+    void Diff(change_cb func);
+};
+
+#endif // _STATE_H
@@ -0,0 +1,359 @@
+#ifndef _SYNC_H
+#define _SYNC_H
+
+#include <Arduino.h>
+#include "Domain.h"
+
+// define to exchange the Sync frames with a simulated robot peer rather than over ESP-NOW
+//#define SYNC_SIM
+
+/**
+  * @brief     Callback function for applying a Property value decoded from a Sync frame
+  * @param     entity the ID of the Entity
+  * @param     property the ID of the Property
+  * @param     v the new value
+  */
+typedef void (*sync_cb)(EntityID entity, PropertyID property, int16_t v);
+
+/**
+  * @brief     Callback function for delivering a held back Property change
+  * @param     entity the ID of the Entity
+  * @param     property the ID of the changed Property
+  */
+typedef void (*deliver_cb)(EntityID entity, PropertyID property);
+
+/**
+ * @brief A Property a UI page wants to receive, and how often
+ */
+struct Subscription
+{
+    EntityID entity;        // the ID of the Entity
+    PropertyID property;    // the ID of the Property
+    uint8_t rate;           // maximum updates per second, 0 for unlimited
+};
+
+/**
+ * @brief Filtering of a jittery Property received from the robot, before it reaches the State
+ */
+struct TelemetryFilter
+{
+    EntityID entity;        // the ID of the Entity
+    PropertyID property;    // the ID of the Property
+    uint8_t deadband;       // changes of at most this much from the value last passed are dropped, except to 0
+    uint8_t quantum;        // values are rounded to a multiple of this, 0 or 1 for none,
+                            // keep the deadband below it, or every single step is dropped
+    uint16_t interval;      // minimum msec between values passed, later changes are held, 0 for none
+};
+
+/**
+ * @brief Compact binary synchronization of Property deltas between Domains
+ * @remarks A Sync frame packs many Entity/Property changes into a single ESP-NOW message:
+ *      magic byte, flags byte, varint sequence number, 2 byte stamp, then records of
+ *      varint EntityID, varint PropertyID and zigzag varint value until the end of the frame.
+ *      The stamp is the sender's micros() / 1000, low bits first, so the receiver can tell how old
+ *      the values are, once it knows how far apart the two clocks are.
+ *      Every keyframeInterval msec a keyframe carries the full state of all known Properties,
+ *      with the Subscriptions sent again alongside, so a receiver can recover from lost frames
+ *      or a restart, even with the controls idle.
+ *      A subscribe frame instead carries records of the robot's Properties the active UI page displays
+ *      with their maximum update rates as values, so the robot only sends what is shown,
+ *      and none of the controller's own values back.
+ *      A time frame instead carries an NTP style clock exchange as three 4 byte micros() times:
+ *      when the controller sent it, and when the robot received and answered it, 0 in the request.
+ *      With the time the answer arrived, they give the offset of the robot's clock and the round trip,
+ *      the fastest recent exchange giving the best offset, and a line fitted to the fastest
+ *      of each window of exchanges over the last four minutes the drift.
+ *      Knowing the offset turns each leg of the round trip, and each stamp, into a one-way latency.
+ *
+ *      The coalesced changes are handed to the Domain to be sent one Property at a time,
+ *      until the robot answers a clock exchange, which a robot without the frames never does.
+ *      Sync frames are then used, until the answers stop for answerTimeout.
+ *      ESP-NOW has a single receive callback, so Sync takes the Domain's, linked with
+ *      -Wl,--wrap=esp_now_register_recv_cb, and passes it the packets that are not Sync frames.
+ *
+ *      Each Property has one owner, the side whose value is authoritative: the controller sets
+ *      the Goals and Animation, the robot measures the RPM, Power and Position. Values only flow
+ *      from their owner, so neither side bounces the other's values back, and changes received
+ *      for the controller's own Properties are suppressed as echoes rather than redrawn.
+ */
+namespace Sync
+{
+    const uint8_t frameMagic = 0xD5;        // first byte of every Sync frame
+    const uint8_t frameMax = 250;           // maximum ESP-NOW payload
+    const uint16_t keyframeInterval = 1000; // msec between full state keyframes, sent idle or not
+    const uint16_t clockInterval = 1000;    // msec between clock exchanges
+    const uint8_t clockWindow = 8;          // the recent exchanges the best offset is chosen from
+    const uint16_t answerTimeout = 5000;    // msec without a clock exchange answered before going back to the Domain's messages
+
+    /**
+     * @brief Flags carried in the second byte of a Sync frame
+     */
+    enum FrameFlags
+    {
+        FrameFlags_Keyframe = 0x01,     // frame carries the full state
+        FrameFlags_Subscribe = 0x02,    // frame carries the Subscription list
+        FrameFlags_Stamped = 0x04,      // the 2 byte stamp follows the sequence number
+        FrameFlags_Time = 0x08,         // frame carries a clock exchange rather than records
+    };
+
+    /**
+     * @brief The side of the link a Property's value comes from
+     */
+    enum Owners
+    {
+        Owner_Controller,   // set here and followed by the robot
+        Owner_Robot,        // measured by the robot and only shown here
+    };
+
+    /**
+     * @brief Counters for measuring the Sync traffic
+     */
+    struct Stats
+    {
+        uint32_t sets;          // Property values set, each a transmission in the one-at-a-time scheme
+        uint32_t updates;       // Property values actually transmitted after coalescing
+        uint32_t frames;        // frames transmitted
+        uint32_t keyframes;     // of which were keyframes
+        uint32_t bytes;         // frame bytes transmitted
+        uint32_t received;      // frames decoded
+        uint32_t lost;          // frames missing from the received sequence
+        uint32_t delivered;     // received changes delivered to the UI
+        uint32_t unsubscribed;  // received changes dropped as not displayed
+        uint32_t throttled;     // received changes held back by the Subscription rate
+        uint32_t accepted;      // received changes passed on to the State
+        uint32_t filtered;      // received changes dropped by a deadband
+        uint32_t deferred;      // received changes held back by a filter interval
+        uint32_t echoes;        // received changes to the controller's own Properties, suppressed
+        uint32_t refused;       // sets of the robot's Properties, not sent back
+    };
+
+    /**
+     * @brief The estimate of the robot's clock and the link latencies, from the clock exchanges
+     */
+    struct Clock
+    {
+        bool valid;             // an exchange has completed
+        int32_t offset;         // usec the robot's micros() is ahead of ours
+        int32_t drift;          // parts per billion the robot's clock runs fast
+        uint32_t roundTrip;     // usec of the exchange the offset is from
+        uint32_t up;            // usec a frame takes to reach the robot, averaged
+        uint32_t down;          // usec a frame takes to arrive from the robot, averaged
+        uint32_t age;           // msec old the robot's values are when decoded, averaged
+        uint32_t ageMax;        // msec of the oldest values decoded
+        uint32_t exchanges;     // exchanges completed
+    };
+
+    /**
+     * @brief Initialize Sync with the robot peer
+     *
+     * @param peer The MAC address of the peer to send frames to
+     */
+    void Init(const uint8_t* peer);
+
+    /**
+     * @brief Offer the Sync frames to the robot, or keep to the Domain's messages
+     *
+     * @param on true to send clock exchanges and take up the frames once the robot answers one,
+     *      false to hand the changes to the Domain only
+     */
+    void UseFrames(bool on);
+
+    /**
+     * @brief Get whether the Sync frames are in use, rather than the Domain's messages
+     */
+    bool Frames();
+
+    /**
+     * @brief Get the owner of a Property
+     *
+     * @param property The ID of the Property
+     * @return Owners The side whose value is authoritative
+     */
+    Owners Owner(PropertyID property);
+
+    /**
+     * @brief Queue a new value for a Property to be sent on the next Flush
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the Property
+     * @param v The value to set
+     * @remarks Repeated sets of a Property before the Flush are coalesced into one update.
+     *      The value is published to the State as set, the robot's echo of it is not waited for.
+     *      Sets of Properties the robot owns are refused.
+     */
+    void Set(EntityID entity, PropertyID property, int16_t v);
+
+    /**
+     * @brief Get the value last set for a Property the controller owns
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the Property
+     * @return int16_t The value, 0 if never set
+     */
+    int16_t Value(EntityID entity, PropertyID property);
+
+    /**
+     * @brief Replace the filters applied to changes received from the robot
+     *
+     * @param list The list of filters, which must remain valid until replaced
+     * @param count The number of filters in the list
+     */
+    void Filter(const TelemetryFilter* list, uint8_t count);
+
+    /**
+     * @brief Filter a change received from the robot by the owner of the Property and its filter
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the changed Property
+     * @param v The new value, quantized in place
+     * @return true if the change should be passed on, false for an echo of the controller's own
+     *      or a change dropped or held back by its filter
+     */
+    bool Receive(EntityID entity, PropertyID property, int16_t& v);
+
+    /**
+     * @brief Pass on the held back changes whose filter interval has elapsed
+     *
+     * @param func A callback function to apply each change
+     * @remarks Call once per control tick, after processing the received changes
+     */
+    void Settle(sync_cb func);
+
+    /**
+     * @brief Send all queued Property changes
+     * @remarks Call once per control tick
+     */
+    void Flush();
+
+    /**
+     * @brief Write an unsigned value as a varint, 7 bits per byte, low bits first
+     *
+     * @param p Pointer to the output position, advanced past the bytes written
+     * @param v The value to write
+     */
+    void PutVarint(uint8_t*& p, uint16_t v);
+
+    /**
+     * @brief Read an unsigned varint
+     *
+     * @param p Pointer to the input position, advanced past the bytes read
+     * @param end Pointer to the end of the input
+     * @param v Receives the value read
+     * @return true if a complete varint was read
+     */
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint16_t& v);
+
+    // zigzag encoding maps small negative values to small unsigned values: 0, -1, 1, -2, 2...
+    inline uint16_t ZigZag(int16_t v) { return (uint16_t)((v << 1) ^ (v >> 15)); }
+    inline int16_t UnZigZag(uint16_t v) { return (int16_t)((v >> 1) ^ -(int16_t)(v & 1)); }
+
+    /**
+     * @brief Write a fixed size value, low bytes first
+     *
+     * @param p Pointer to the output position, advanced past the bytes written
+     * @param v The value to write
+     * @param size The bytes to write, 1 to 4
+     */
+    void PutFixed(uint8_t*& p, uint32_t v, uint8_t size);
+
+    /**
+     * @brief Read a fixed size value
+     *
+     * @param p Pointer to the input position, advanced past the bytes read
+     * @param end Pointer to the end of the input
+     * @param v Receives the value read
+     * @param size The bytes to read, 1 to 4
+     * @return true if all the bytes were there
+     */
+    bool GetFixed(const uint8_t*& p, const uint8_t* end, uint32_t& v, uint8_t size);
+
+    /**
+     * @brief Get the frame stamp for a micros() time
+     */
+    inline uint16_t Stamp(uint32_t usec) { return (uint16_t)(usec / 1000); }
+
+    /**
+     * @brief Encode the queued Property changes into a Sync frame
+     *
+     * @param buf The buffer to receive the frame, at least frameMax bytes
+     * @param keyframe true to encode all known Properties rather than just the changes
+     * @return int The length of the frame, 0 if there is nothing to send
+     * @remarks Properties that do not fit remain queued for the next frame
+     */
+    int Encode(uint8_t* buf, bool keyframe);
+
+    /**
+     * @brief Decode a received Sync frame
+     *
+     * @param data The frame data
+     * @param len The length of the frame data
+     * @param func A callback function to apply each decoded Property value
+     * @param subFunc An optional callback function for each Subscription in a subscribe frame,
+     *      with the rate as the value
+     * @param usec micros() when the frame arrived, for the clock exchange and the age of the values
+     * @return true if the frame was well formed
+     */
+    bool Decode(const uint8_t* data, int len, sync_cb func, sync_cb subFunc = nullptr, uint32_t usec = 0);
+
+    /**
+     * @brief Queue a frame received from the robot, to be decoded by Poll
+     *
+     * @param data The frame data
+     * @param len The length of the frame data
+     * @param usec micros() when the frame arrived
+     * @remarks Call from the radio receive callback
+     */
+    void Post(const uint8_t* data, int len, uint32_t usec);
+
+    /**
+     * @brief Decode the frames received from the robot
+     *
+     * @param func A callback function to apply each decoded Property value
+     * @remarks Call once per control tick, before processing the received changes
+     */
+    void Poll(sync_cb func);
+
+    /**
+     * @brief Get the estimate of the robot's clock and the link latencies
+     */
+    const Clock& GetClock();
+
+    /**
+     * @brief Replace the Properties wanted by the active UI page
+     *
+     * @param subs The list of Subscriptions, which must stay valid, as a send of it may still be under way once replaced
+     * @param count The number of Subscriptions in the list
+     * @remarks Called by the UI, the list is sent to the robot with the next Flush by the control task
+     */
+    void Subscribe(const Subscription* subs, uint8_t count);
+
+    /**
+     * @brief Filter a change received from the robot against the Subscriptions
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the changed Property
+     * @return true if the change should be processed now
+     * @remarks Changes arriving faster than their rate are held back and delivered later by Deliver,
+     *      which reports only the IDs, the latest value being read by the caller
+     */
+    bool Accept(EntityID entity, PropertyID property);
+
+    /**
+     * @brief Deliver held back changes whose Subscription interval has elapsed
+     *
+     * @param func A callback function to process each change
+     */
+    void Deliver(deliver_cb func);
+
+    /**
+     * @brief Get the traffic counters
+     */
+    const Stats& GetStats();
+
+    /**
+     * @brief Log a summary of the traffic and filter counters
+     */
+    void Report();
+};
+
+#endif // _SYNC_H
@@ -0,0 +1,40 @@
+#ifndef _TEXT_H
+#define _TEXT_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief Fast text rendering in the 12x16 character cells of the scaled built-in font
+ * @remarks Adafruit_GFX draws scaled text a 2x2 rectangle at a time, a transaction for each.
+ *      Here each glyph is expanded once, on first use, into a cache of doubled 12-bit rows,
+ *      and a whole span of characters is written in one address window burst,
+ *      a pixel row at a time, with the foreground and background colors filled from a table.
+ *      Only the printable ASCII characters are cached, others are drawn as '?'.
+ */
+namespace Text
+{
+    /**
+     * @brief Draw a span of characters, with their background
+     *
+     * @param x The left of the span
+     * @param y The top of the span
+     * @param s The text
+     * @param n The characters in the span, text shorter than this is padded with spaces
+     * @param fg The text color
+     * @param bg The background color
+     * @remarks The span is clipped to the screen width
+     */
+    void Draw(int16_t x, int16_t y, const char* s, uint8_t n, uint16_t fg, uint16_t bg);
+
+    /**
+     * @brief Print text at the tft cursor, wrapping at the screen edge and advancing the cursor
+     *
+     * @param s The text, '\n' starts a new line and '\r' is ignored
+     * @param fg The text color
+     * @param bg The background color
+     * @return int The number of characters printed
+     */
+    int Print(const char* s, uint16_t fg, uint16_t bg);
+};
+
+#endif // _TEXT_H
@@ -0,0 +1,68 @@
+#ifndef _TOUCH_H
+#define _TOUCH_H
+
+#include "PSXPad.h"
+
+/**
+ * @brief The gestures recognized on the touchscreen
+ */
+enum TouchGestures
+{
+    Touch_Tap,          // brief touch and release in place
+    Touch_LongPress,    // touch held in place, reported once while still held
+    Touch_DragStart,    // touch moved far enough to become a drag
+    Touch_Drag,         // drag moved, dx and dy are the movement since the drag started
+    Touch_DragEnd,      // drag released
+    Touch_SwipeLeft,    // quick horizontal drag to the left, reported on release
+    Touch_SwipeRight,   // quick horizontal drag to the right, reported on release
+};
+
+/**
+ * @brief A gesture event
+ */
+struct TouchEvent
+{
+    TouchGestures gesture;  // the gesture recognized
+    int16_t x;              // the current screen position
+    int16_t y;
+    int16_t dx;             // movement since the touch started
+    int16_t dy;
+};
+
+/**
+  * @brief     Callback function for processing touch gestures
+  * @param     e the gesture event
+  */
+typedef void (*touch_cb)(const TouchEvent& e);
+
+/**
+ * @brief Interrupt-driven touchscreen input and gesture recognition
+ * @remarks The STMPE610 interrupt signals new samples or a touch/release,
+ *      so there is no SPI traffic at all while the screen is untouched.
+ *      Each interrupt drains the whole sample FIFO in one burst,
+ *      averaging the valid samples into one calibrated point.
+ *      The interrupt needs the FeatherWing's IRQ jumper closed, so until the first interrupt
+ *      the FIFO is also polled each loop, and an unjumpered board still works, only without
+ *      the quiet bus or waking from light sleep on a touch.
+ */
+namespace Touch
+{
+    /**
+     * @brief Initialize the touchscreen interrupt, after ts.begin()
+     */
+    void Init();
+
+    /**
+     * @brief Perform periodic loop() processing to read samples and recognize gestures
+     *
+     * @param func A callback function to notify the caller of gestures
+     */
+    void Loop(touch_cb func);
+
+    /**
+     * @brief Determine if the screen is being touched
+     */
+    bool Down();
+};
+
+#endif // _TOUCH_H
@@ -0,0 +1,91 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include "PSXPad.h"
+#include "Profiler.h"
+
+/**
+ * @brief High-rate binary tracing of Property values, stage times and pad state over Serial
+ * @remarks Records are queued by the control task and the UI loop under a brief spinlock
+ *      and drained lock-free to Serial in frames by a low priority task,
+ *      so tracing costs the loops only a few stores per record.
+ *      A host sends 'b' to start binary streaming and 't' to stop it;
+ *      tools/trace_decode.py does this and converts the stream to Teleplot or CSV.
+ *
+ *      Property samples are taken by the UI loop, which rests longer in the idle power modes,
+ *      so their rate drops there, but every record carries the time it was taken.
+ *
+ *      Frame: 0xA5 0x5A, record count, records..., checksum (XOR of the records' bytes)
+ *      Record (little endian, 9 bytes): uint32 time in usec, uint8 kind, uint8 a, uint8 b, int16 value
+ */
+namespace Trace
+{
+    const uint8_t sync0 = 0xA5;     // first frame sync byte
+    const uint8_t sync1 = 0x5A;     // second frame sync byte
+    const uint16_t rateDefault = 100;   // Property samples per second
+
+    /**
+     * @brief The kinds of record
+     */
+    enum Kinds
+    {
+        Kind_Property,  // a = EntityID, b = PropertyID, value = the Property value
+        Kind_Stage,     // a = Profiler::Sections, value = usec spent in the section over a control tick
+        Kind_Pad,       // a = PadKeys, b = 0 for x or 1 for y, value = the key value
+    };
+
+    /**
+     * @brief Start the draining task
+     */
+    void Init();
+
+    /**
+     * @brief Determine if binary streaming is active
+     * @remarks Text output to Serial must be suppressed while active
+     */
+    bool Active();
+
+    /**
+     * @brief Add a Property to sample
+     *
+     * @param entity The ID of the Entity
+     * @param property The ID of the Property
+     */
+    void Select(EntityID entity, PropertyID property);
+
+    /**
+     * @brief Set the Property sampling rate
+     *
+     * @param hz Samples per second
+     */
+    void SetRate(uint16_t hz);
+
+    /**
+     * @brief Perform periodic loop() processing to sample the selected Properties from the State snapshot when due
+     */
+    void Loop();
+
+    /**
+     * @brief Record the time spent in a stage over a control tick
+     *
+     * @param section The Profiler section timed
+     * @param usec The total time spent, however many times it ran
+     */
+    void Stage(Profiler::Sections section, uint32_t usec);
+
+    /**
+     * @brief Record pad activity
+     *
+     * @param btn the PSX button, joystick or knob changed
+     * @param x the x (or only) value
+     * @param y the (optional) y value
+     */
+    void Key(PadKeys btn, int16_t x, int16_t y);
+
+    /**
+     * @brief Get the number of records dropped because the queue was full
+     */
+    uint32_t Dropped();
+};
+
+#endif // _TRACE_H
@@ -0,0 +1,88 @@
+#include "Arbiter.h"
+
+namespace Arbiter
+{
+float demands[Source_Count][Axis_Count];    // each source's demand on each axis
+int8_t latches[wheelCount];                 // the knob goals
+bool guided = false;                        // the velocity owned the wheels last tick
+Command last;                               // the command last resolved
+bool changed = true;                        // a latch or stop changed the command
+
+void Demand(Sources source, Axes axis, float v)
+{
+    demands[source][axis] = v;
+}
+
+/**
+ * @brief Determine if a velocity source is active
+ */
+bool Guided()
+{
+    for (int s = 0; s < Source_Count; s++)
+    {
+        for (int a = Axis_X; a <= Axis_W; a++)
+        {
+            if (demands[s][a] != 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+bool Latch(uint8_t wheel, int8_t goal)
+{
+    if (wheel >= wheelCount || Guided())
+        return false;
+    if (latches[wheel] != goal)
+    {
+        latches[wheel] = goal;
+        changed = true;
+    }
+    return true;
+}
+
+void Stop()
+{
+    memset(demands, 0, sizeof(demands));
+    memset(latches, 0, sizeof(latches));
+    changed = true;
+}
+
+/**
+ * @brief Determine if two commands drive the same
+ */
+bool Same(const Command& a, const Command& b)
+{
+    return memcmp(a.v, b.v, sizeof(a.v)) == 0 && a.guided == b.guided && memcmp(a.goals, b.goals, sizeof(a.goals)) == 0;
+}
+
+bool Resolve(Command& cmd)
+{
+    // each axis goes to the first source, by priority, off neutral on it
+    for (int a = 0; a < Axis_Count; a++)
+    {
+        cmd.v[a] = 0;
+        for (int s = 0; s < Source_Count; s++)
+        {
+            if (demands[s][a] != 0)
+            {
+                cmd.v[a] = demands[s][a];
+                break;
+            }
+        }
+    }
+    cmd.guided = Guided();
+    // taking the wheels drops the latches, so they do not resume when the sticks are let go
+    cmd.unlatched = cmd.guided && !guided;
+    if (cmd.unlatched)
+        memset(latches, 0, sizeof(latches));
+    guided = cmd.guided;
+    memcpy(cmd.goals, latches, sizeof(latches));
+    if (!changed && !cmd.unlatched && Same(cmd, last))
+        return false;
+    changed = false;
+    last = cmd;
+    return true;
+}
+
+};
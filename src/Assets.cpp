@@ -0,0 +1,108 @@
+#include "Assets.h"
+#include "FLogger.h"
+
+// the blob embedded by board_build.embed_files
+extern const uint8_t blobStart[] asm("_binary_assets_ui_bin_start");
+extern const uint8_t blobEnd[] asm("_binary_assets_ui_bin_end");
+
+namespace Assets
+{
+const uint32_t magic = 0x31415850;  // 'PXA1'
+const uint8_t nameMax = 12;
+const uint16_t chunkPixels = 256;   // pixels decoded between writes
+
+/**
+ * @brief The blob header
+ */
+struct Header
+{
+    uint32_t magic;
+    uint16_t count;
+    uint16_t reserved;
+};
+
+/**
+ * @brief An index entry of the blob
+ */
+struct Entry
+{
+    char name[nameMax];
+    uint16_t width;
+    uint16_t height;
+    uint32_t offset;
+    uint32_t size;
+};
+
+uint16_t count = 0;     // the images in a valid blob
+
+bool Init()
+{
+    // the blob may not be word aligned, so the header is copied out
+    Header h = { 0, 0, 0 };
+    uint32_t blobSize = blobEnd - blobStart;
+    if (blobSize >= sizeof(h))
+        memcpy(&h, blobStart, sizeof(h));
+    if (h.magic != magic || sizeof(Header) + h.count * sizeof(Entry) > blobSize)
+    {
+        floge("asset blob invalid");
+        count = 0;
+        return false;
+    }
+    count = h.count;
+    flogi("%u assets, %u bytes", count, blobSize);
+    return true;
+}
+
+bool Find(const char* name, Image& img)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        Entry e;
+        memcpy(&e, blobStart + sizeof(Header) + i * sizeof(Entry), sizeof(e));
+        if (strncasecmp(e.name, name, nameMax) == 0)
+        {
+            img = { e.width, e.height, blobStart + e.offset, e.size };
+            return true;
+        }
+    }
+    img = { 0, 0, nullptr, 0 };
+    return false;
+}
+
+void Draw(const Image& img, int16_t x, int16_t y)
+{
+    if (img.data == nullptr || x < 0 || y < 0 || x + img.width > tftWidth || y + img.height > tftHeight)
+        return;
+    static uint16_t chunk[chunkPixels];
+    uint16_t n = 0;
+    const uint8_t* p = img.data;
+    const uint8_t* end = p + img.size;
+    tft.startWrite();
+    tft.setAddrWindow(x, y, img.width, img.height);
+    while (p < end)
+    {
+        uint8_t control = *p++;
+        bool run = control >= 0x80;
+        uint8_t len = run ? control - 0x80 + 2 : control + 1;
+        uint16_t pixel = 0;
+        for (uint8_t i = 0; i < len; i++)
+        {
+            if (!run || i == 0)
+            {
+                pixel = p[0] | (p[1] << 8);
+                p += 2;
+            }
+            chunk[n++] = pixel;
+            if (n == chunkPixels)
+            {
+                tft.writePixels(chunk, n);
+                n = 0;
+            }
+        }
+    }
+    if (n > 0)
+        tft.writePixels(chunk, n);
+    tft.endWrite();
+}
+
+};
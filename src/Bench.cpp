@@ -0,0 +1,235 @@
+#include "Bench.h"
+#include "Controller.h"
+#include "Echo.h"
+#include "Layout.h"
+#include "FLogger.h"
+
+namespace Pad
+{
+// the change detection of Pad::Loop, benchmarked without the PSX hardware
+bool ProcessStickXY(Point& p, int16_t x, int16_t y);
+bool ProcessBtn(Point& p, byte x);
+};
+
+namespace Bench
+{
+/**
+ * @brief A benchmark case and its budget, the most cycles allowed per event, 0 for unchecked
+ */
+struct Case
+{
+    const char* name;
+    Result (*run)();    // runs eventCount events
+    uint32_t cycles;
+};
+
+Result start;               // the counts when measuring started
+volatile uint32_t sink;     // keeps the results of the pure functions alive
+
+/**
+ * @brief Start measuring
+ */
+void Start()
+{
+#ifdef DISPLAY_COUNTS
+    start = { ESP.getCycleCount(), tft.pixels, tft.windows, tft.bytes };
+#else
+    start = { ESP.getCycleCount(), 0, 0, 0 };
+#endif
+}
+
+/**
+ * @brief Stop measuring
+ *
+ * @return Result The work done since Start
+ */
+Result Stop()
+{
+#ifdef DISPLAY_COUNTS
+    return { ESP.getCycleCount() - start.cycles, tft.pixels - start.pixels, tft.windows - start.windows, tft.bytes - start.bytes };
+#else
+    return { ESP.getCycleCount() - start.cycles, 0, 0, 0 };
+#endif
+}
+
+/**
+ * @brief The joystick change detection, on a sweep that changes every event
+ */
+Result Stick()
+{
+    Point p = { 0, 0 };
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        sink += Pad::ProcessStickXY(p, i & 0xFF, (i * 7) & 0xFF);
+    return Stop();
+}
+
+/**
+ * @brief The button change detection, alternating pressures
+ */
+Result Button()
+{
+    Point p = { 0, 0 };
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        sink += Pad::ProcessBtn(p, (i & 1) ? 0xFF : 0);
+    return Stop();
+}
+
+/**
+ * @brief The Pad::Loop walk of the 16 buttons, when none changed
+ */
+Result Walk()
+{
+    Point btns[16] = {};
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+    {
+        for (Point& p : btns)
+            sink += Pad::ProcessBtn(p, 0);
+    }
+    return Stop();
+}
+
+/**
+ * @brief Left stick control, a tick each, through the Arbiter and Guidance matrix to the motor goals
+ */
+Result Guidance()
+{
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+    {
+        Controller::ProcessKey(PadKeys_leftStick, (int16_t)(i % 201) - 100, (int16_t)((i * 3) % 201) - 100);
+        Controller::Loop();
+    }
+    Result r = Stop();
+    // leave the robot stopped
+    Controller::ProcessKey(PadKeys_cross, 0xFF, 0);
+    Controller::ProcessKey(PadKeys_cross, 0, 0);
+    Controller::Loop();
+    return r;
+}
+
+/**
+ * @brief A text widget counting up
+ */
+Result Text()
+{
+    constexpr Layout::Widget w = { Layout::Widget_Text, 1, 0, 4, 1, HX8357_WHITE, EntityID_None, PropertyID_None, 0, 0, nullptr };
+    constexpr Layout::Rect r = Layout::Place(w);
+    Layout::WidgetState s = {};
+    s.node = -1;
+    Layout::Update(w, r, s, 0);
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        Layout::Update(w, r, s, i + 1);
+    return Stop();
+}
+
+/**
+ * @brief A bar widget sweeping across its range
+ */
+Result Bar()
+{
+    constexpr Layout::Widget w = { Layout::Widget_Bar, 1, 1, 12, 1, HX8357_CYAN, EntityID_None, PropertyID_None, -100, 100, nullptr };
+    constexpr Layout::Rect r = Layout::Place(w);
+    Layout::WidgetState s = {};
+    s.node = -1;
+    Layout::Update(w, r, s, -100);
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        Layout::Update(w, r, s, (int16_t)i - 99);
+    return Stop();
+}
+
+/**
+ * @brief The Echo page showing Cross presses and releases
+ */
+Result EchoButton()
+{
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        Echo::ProcessKey(PadKeys_cross, (i & 1) ? 0 : 0xFF, 0);
+    return Stop();
+}
+
+/**
+ * @brief The Echo page showing left stick movement
+ */
+Result EchoStick()
+{
+    Start();
+    for (uint16_t i = 0; i < eventCount; i++)
+        Echo::ProcessKey(PadKeys_leftStick, (int16_t)(i % 100) + 1, -(int16_t)(i % 50) - 1);
+    return Stop();
+}
+
+/**
+ * @brief The cases and their cycle budgets
+ * @remarks The drawing cases are bound by the SPI bus rather than the CPU, so their cycles are
+ *      left unchecked; their pixels and windows are budgeted by the host baselines.
+ */
+const Case cases[] =
+{
+    //  name          run          cycles
+    { "stick",      Stick,          120 },
+    { "button",     Button,          60 },
+    { "walk",       Walk,           900 },
+    { "guidance",   Guidance,      6000 },
+    { "text",       Text,             0 },
+    { "bar",        Bar,              0 },
+    { "echo btn",   EchoButton,       0 },
+    { "echo stick", EchoStick,        0 },
+};
+
+/**
+ * @brief Determine if a total is over its budget for the events, 0 for unchecked
+ */
+inline bool Over(uint32_t total, uint32_t budget)
+{
+    return budget != 0 && total > budget * eventCount;
+}
+
+/**
+ * @brief Run a case, the Echo cases over the Echo page
+ */
+Result Measure(const Case& c)
+{
+    bool echo = c.run == EchoButton || c.run == EchoStick;
+    if (echo)
+        Echo::Activate();
+    Result r = (*c.run)();
+    if (echo)
+        Echo::Deactivate();
+    return r;
+}
+
+bool Measure(const char* name, Result& r)
+{
+    for (const Case& c : cases)
+    {
+        if (strcmp(c.name, name) != 0)
+            continue;
+        r = Measure(c);
+        return true;
+    }
+    return false;
+}
+
+bool Run()
+{
+    bool pass = true;
+    for (const Case& c : cases)
+    {
+        Result r = Measure(c);
+        flogi("bench %-10s %6u cyc %5u px %2u win %5u B", c.name, r.cycles / eventCount, r.pixels / eventCount, r.windows / eventCount, r.bytes / eventCount);
+        if (Over(r.cycles, c.cycles))
+        {
+            floge("bench %s over budget", c.name);
+            pass = false;
+        }
+    }
+    return pass;
+}
+
+};
@@ -0,0 +1,110 @@
+#include "Boot.h"
+#include "FLogger.h"
+#include <atomic>
+
+namespace Boot
+{
+const uint32_t stageStack = 4096;   // WiFi init is the deepest stage
+const UBaseType_t stagePriority = 1;
+const BaseType_t stageCore = 0;     // the control core, idle until the control task starts
+
+/**
+ * @brief A stage in the timeline
+ */
+struct Stage
+{
+    const char* name;
+    stage_fn func;
+    uint32_t start;     // millis() at start
+    uint32_t end;       // millis() at end
+    bool started;       // run concurrently on the control core
+};
+
+Stage stages[stageMax];
+uint8_t stageCount = 0;
+std::atomic<uint8_t> running(0);    // the started stages not yet complete
+portMUX_TYPE stageMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Add a stage to the timeline
+ *
+ * @return Stage* The new stage, or nullptr if the timeline is full
+ */
+Stage* Add(const char* name, stage_fn func, bool started)
+{
+    Stage* s = nullptr;
+    portENTER_CRITICAL(&stageMux);
+    if (stageCount < stageMax)
+        s = &stages[stageCount++];
+    portEXIT_CRITICAL(&stageMux);
+    if (s == nullptr)
+        return nullptr;
+    s->name = name;
+    s->func = func;
+    s->start = millis();
+    s->end = s->start;
+    s->started = started;
+    return s;
+}
+
+void Run(const char* name, stage_fn func)
+{
+    Stage* s = Add(name, func, false);
+    (*func)();
+    if (s != nullptr)
+        s->end = millis();
+}
+
+/**
+ * @brief The task running a started stage
+ *
+ * @param param The Stage
+ */
+void StageTask(void* param)
+{
+    Stage* s = (Stage*)param;
+    (*s->func)();
+    s->end = millis();
+    running--;
+    vTaskDelete(nullptr);
+}
+
+void Start(const char* name, stage_fn func)
+{
+    Stage* s = Add(name, func, true);
+    running++;
+    if (s == nullptr || xTaskCreatePinnedToCore(StageTask, name, stageStack, s, stagePriority, nullptr, stageCore) != pdPASS)
+    {
+        // no timeline slot or no task, run it in line
+        floge("Boot %s not started", name);
+        (*func)();
+        if (s != nullptr)
+            s->end = millis();
+        running--;
+    }
+}
+
+void Join()
+{
+    while (running > 0)
+        delay(1);
+}
+
+void Mark(const char* name)
+{
+    Add(name, nullptr, false);
+}
+
+void Report()
+{
+    for (uint8_t i = 0; i < stageCount; i++)
+    {
+        const Stage& s = stages[i];
+        if (s.func == nullptr)
+            flogi("boot %-8s    %5u ms", s.name, s.start);
+        else
+            flogi("boot %-8s %c %5u-%5u ms", s.name, s.started ? '|' : ' ', s.start, s.end);
+    }
+}
+
+};
@@ -3,6 +3,13 @@
 #include "PSXPad.h"
 #include "Pad.h"
 #include "NavLightsBase.h"
+#include "Sync.h"
+#include "Layout.h"
+#include "History.h"
+#include "Scene.h"
+#include "State.h"
+#include "Arbiter.h"
+#include "Format.h"
 
 namespace Controller
 {
@@ -18,47 +25,54 @@ ControlModes ControlMode = Control_Limited;     // the current control mode
 
 float factorMode = 0.5f;    // the current ControlMode range factor
 
-//
-// from "Motion Planning for Omnidirectional Wheeled Mobile Robot by Potential Field Method" equation (7)
-// as computed by the custom program 'OmniCtrl'
-// the matrix 'M', from columns A1, A2, and A3
-// which will be multiplied by the robot velocity and spin vector to produce the wheel rotation vector
-//
-float M00 = -0.0110, M01 = -0.0235, M02 = 2.7273;
-float M10 =	-0.0110, M11 =  0.0235, M12 = 2.7273;
-float M20 =  0.0260, M21 =  0.0000, M22 = 3.7662;
+const Profile* profile = nullptr;   // the active control Profile
 
 //
 // the desired robot velocity x and y components and the desired rotational velocity in radians
 //
 float velOx = 0, velOy = 0, velOw = 0;
 
-//
-// the output wheel rotational velocities in radians
-//
-float velW0 = 0, velW1 = 0, velW2 = 0;
-
 //
 // the resulting wheel RPMs
 //
 int8_t rpm0 = 0, rpm1 = 0, rpm2 = 0;
 
-// the following have been designed using the custom OmniCtrl program to limit motor RPMs to 100:
-// 'translate' mode multiplier for arbitrary X & Y stick values [-100..100],
-//      converting to actual bot X & Y translation speeds (mm/sec)
-const float factorTrans = 4.031f;
+// convert rotation in radians/sec to RPM
+const float rot2RPM = 60.0f / (2 * PI);
 
-// 'tractor' mode multiplier for arbitrary X stick values [-100..100] controlling spin,
-//      converting to actual rotation speed (radians/sec)
-// Y stick deflection controls forward translation as in translate mode
-const float factorSpinT = 0.027f;
+//
+// derived from the active Profile and ControlMode when either changes
+//
+// the Profile matrix 'M', scaled to produce wheel RPMs rather than radians/sec
+float K[3][3];
+// the Profile factors scaled by factorMode
+float gainTrans = 0, gainSpinT = 0, gainSpin = 0;
 
-// 'spin' mode multiplier for arbitrary button values [0..255],
-//      converting to actual rotation speed (radians/sec)
-const float factorSpin = (0.027f * 100.0f) / 255.0f;
+/**
+ * @brief Recompute the gains for the ControlMode
+ */
+void UpdateGains()
+{
+    if (profile == nullptr)
+        return;
+    factorMode = profile->modeFactors[ControlMode];
+    gainTrans = profile->factorTrans * factorMode;
+    gainSpinT = profile->factorSpinT * factorMode;
+    gainSpin = profile->factorSpin * factorMode;
+    // the UI shows the mode from the published State
+    State::Set(EntityID_None, PropertyID_ControlMode, ControlMode);
+}
 
-// convert rotation in radians/sec to RPM
-const float rot2RPM = 60.0f / (2 * PI);
+void SetProfile(const Profile& p)
+{
+    profile = &p;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+            K[i][j] = p.M[i][j] * rot2RPM;
+    }
+    UpdateGains();
+}
 
 /**
  * @brief Calculate the 3 omni-wheel RPMs (rpm0..rpm2) required to produce the desired
@@ -67,158 +81,275 @@ const float rot2RPM = 60.0f / (2 * PI);
  */
 void Guidance()
 {
-    //velW = M * velO;
-    velW0 = M00 * velOx + M01 * velOy + M02 * velOw;
-    velW1 = M10 * velOx + M11 * velOy + M12 * velOw;
-    velW2 = M20 * velOx + M21 * velOy + M22 * velOw;
-    //Serial.printf("velO: %f %f %f\r\n", velOx, velOy, velOw);
-    //Serial.printf("velW: %f %f %f\r\n", velW0, velW1, velW2);
-    // convert wheel rotations in radians/sec to RPM
-    rpm0 = (int8_t)roundf(velW0 * rot2RPM);
-    rpm1 = (int8_t)roundf(velW1 * rot2RPM);
-    rpm2 = (int8_t)roundf(velW2 * rot2RPM);
+    //rpm = K * velO;
+    rpm0 = (int8_t)roundf(K[0][0] * velOx + K[0][1] * velOy + K[0][2] * velOw);
+    rpm1 = (int8_t)roundf(K[1][0] * velOx + K[1][1] * velOy + K[1][2] * velOw);
+    rpm2 = (int8_t)roundf(K[2][0] * velOx + K[2][1] * velOy + K[2][2] * velOw);
     // if any of the RPM goals are above the maximum, ignore the whole set, leaving it as previously set
     if (abs(rpm0) > 100 || abs(rpm1) > 100 || abs(rpm2) > 100)
         return;
     // set the motor goals, which will be sent to the robot
-    VirtualBot.SetEntityPropertyValue(EntityID_LeftMotor, PropertyID_Goal, -rpm0);
-    VirtualBot.SetEntityPropertyValue(EntityID_RightMotor, PropertyID_Goal, rpm1);
-    VirtualBot.SetEntityPropertyValue(EntityID_RearMotor, PropertyID_Goal, rpm2);
+    Sync::Set(EntityID_LeftMotor, PropertyID_Goal, -rpm0);
+    Sync::Set(EntityID_RightMotor, PropertyID_Goal, rpm1);
+    Sync::Set(EntityID_RearMotor, PropertyID_Goal, rpm2);
 }
 
 bool active = true;
 
+bool chartKeyDown = false;  // an L1/L2 chart key is held
+
+using Layout::Widget;
+
 /**
- * @brief A windowing control struct identifying a screen region and information to display there
+ * @brief The widgets to display on the screen, placed on the Layout grid
+ * @remarks A Property may be shown by several widgets
  */
-struct Ctrl
+constexpr Widget widgets[] =
 {
-    /**
-     * @brief A Point containing the x,y position on the screen
-     */
-    Point location;
-    /**
-     * @brief The width on the screen, in characters (as standardized across the system)
-     */
-    uint8_t width;
-    /**
-     * @brief The color of the text
-     */
-    uint16_t textColor;
-    /**
-     * @brief The ID of an Entity to display (unused if label is present)
-     */
-    EntityID entity;
-    /**
-     * @brief The ID of a Property on the Entity to display (unused if label is present)
-     */
-    PropertyID property;
-    /**
-     * @brief The text to display, if present.
-     */
-    const char* label;
+    //  kind                 col row cols rows  color         entity                property                  min   max  label
+    { Layout::Widget_Label,   1,  0,  9,  1, HX8357_GREEN,  EntityID_None,       PropertyID_ControlMode,    0,    0, "Limited" },
+    { Layout::Widget_Text,    1,  1,  4,  1, HX8357_WHITE,  EntityID_Head,       PropertyID_Goal,           0,    0, nullptr },
+    { Layout::Widget_Text,    1,  2,  4,  1, HX8357_WHITE,  EntityID_Head,       PropertyID_Power,          0,    0, nullptr },
+    { Layout::Widget_Text,    1,  3,  4,  1, HX8357_WHITE,  EntityID_Head,       PropertyID_Position,       0,    0, nullptr },
+    { Layout::Widget_Text,   12,  0,  4,  1, HX8357_WHITE,  EntityID_LeftMotor,  PropertyID_Goal,           0,    0, nullptr },
+    { Layout::Widget_Text,   24,  0,  4,  1, HX8357_WHITE,  EntityID_RightMotor, PropertyID_Goal,           0,    0, nullptr },
+    { Layout::Widget_Text,   18,  3,  4,  1, HX8357_WHITE,  EntityID_RearMotor,  PropertyID_Goal,           0,    0, nullptr },
+    { Layout::Widget_Text,   12,  1,  4,  1, HX8357_WHITE,  EntityID_LeftMotor,  PropertyID_RPM,            0,    0, nullptr },
+    { Layout::Widget_Text,   24,  1,  4,  1, HX8357_WHITE,  EntityID_RightMotor, PropertyID_RPM,            0,    0, nullptr },
+    { Layout::Widget_Text,   18,  4,  4,  1, HX8357_WHITE,  EntityID_RearMotor,  PropertyID_RPM,            0,    0, nullptr },
+    { Layout::Widget_Text,   12,  2,  4,  1, HX8357_WHITE,  EntityID_LeftMotor,  PropertyID_Power,          0,    0, nullptr },
+    { Layout::Widget_Text,   24,  2,  4,  1, HX8357_WHITE,  EntityID_RightMotor, PropertyID_Power,          0,    0, nullptr },
+    { Layout::Widget_Text,   18,  5,  4,  1, HX8357_WHITE,  EntityID_RearMotor,  PropertyID_Power,          0,    0, nullptr },
+    { Layout::Widget_Label,  18,  0,  4,  1, HX8357_WHITE,  EntityID_None,       PropertyID_None,           0,    0, "Goal" },
+    { Layout::Widget_Label,  18,  1,  4,  1, HX8357_WHITE,  EntityID_None,       PropertyID_None,           0,    0, "RPM" },
+    { Layout::Widget_Label,  18,  2,  5,  1, HX8357_WHITE,  EntityID_None,       PropertyID_None,           0,    0, "Power" },
+    // lamps lit while a motor is powered
+    { Layout::Widget_Lamp,   13,  3,  2,  1, HX8357_GREEN,  EntityID_LeftMotor,  PropertyID_Power,          1,    0, nullptr },
+    { Layout::Widget_Lamp,   25,  3,  2,  1, HX8357_GREEN,  EntityID_RightMotor, PropertyID_Power,          1,    0, nullptr },
+    { Layout::Widget_Lamp,   23,  4,  2,  1, HX8357_GREEN,  EntityID_RearMotor,  PropertyID_Power,          1,    0, nullptr },
+    // RPM gauges
+    { Layout::Widget_Bar,     1,  6, 12,  1, HX8357_CYAN,   EntityID_LeftMotor,  PropertyID_RPM,         -100,  100, nullptr },
+    { Layout::Widget_Bar,    14,  6, 12,  1, HX8357_CYAN,   EntityID_RightMotor, PropertyID_RPM,         -100,  100, nullptr },
+    { Layout::Widget_Bar,    27,  6, 12,  1, HX8357_CYAN,   EntityID_RearMotor,  PropertyID_RPM,         -100,  100, nullptr },
+    // Head Position trace
+    { Layout::Widget_Sparkline, 28, 3, 11, 3, HX8357_YELLOW, EntityID_Head,      PropertyID_Position,    -100,  100, nullptr },
 };
 
+const int widgetCount = sizeof(widgets) / sizeof(Widget);
+
 /**
- * @brief The controls to display on the screen
+ * @brief The screen rectangles of the widgets, computed from the Layout
  */
-Ctrl ctrls[] =
+struct WidgetRects
 {
-    { { 144,  32 }, 4, HX8357_WHITE, EntityID_LeftMotor,  PropertyID_Goal,  nullptr },
-    { { 288,  32 }, 4, HX8357_WHITE, EntityID_RightMotor, PropertyID_Goal,  nullptr },
-    { { 216, 120 }, 4, HX8357_WHITE, EntityID_RearMotor,  PropertyID_Goal,  nullptr },
-    { { 144,  59 }, 4, HX8357_WHITE, EntityID_LeftMotor,  PropertyID_RPM,   nullptr },
-    { { 288,  59 }, 4, HX8357_WHITE, EntityID_RightMotor, PropertyID_RPM,   nullptr },
-    { { 216, 147 }, 4, HX8357_WHITE, EntityID_RearMotor,  PropertyID_RPM,   nullptr },
-    { { 144,  85 }, 4, HX8357_WHITE, EntityID_LeftMotor,  PropertyID_Power, nullptr },
-    { { 288,  85 }, 4, HX8357_WHITE, EntityID_RightMotor, PropertyID_Power, nullptr },
-    { { 216, 174 }, 4, HX8357_WHITE, EntityID_RearMotor,  PropertyID_Power, nullptr },
-    { { 216,  32 }, 4, HX8357_WHITE, EntityID_None,       PropertyID_None,  "Goal"  },
-    { { 216,  59 }, 4, HX8357_WHITE, EntityID_None,       PropertyID_None,  "RPM"   },
-    { { 216,  85 }, 4, HX8357_WHITE, EntityID_None,       PropertyID_None,  "Power"  },
-    { {  12,  32 }, 9, HX8357_GREEN, EntityID_None,       PropertyID_ControlMode, "Limited" },
-    { {  12,  59 }, 4, HX8357_WHITE, EntityID_Head,       PropertyID_Goal, nullptr },
-    { {  12,  85 }, 4, HX8357_WHITE, EntityID_Head,       PropertyID_Power, nullptr },
-    { {  12, 111 }, 4, HX8357_WHITE, EntityID_Head,       PropertyID_Position, nullptr },
+    Layout::Rect rect[widgetCount];
 };
 
+constexpr WidgetRects PlaceWidgets()
+{
+    WidgetRects rects {};
+    for (int i = 0; i < widgetCount; i++)
+        rects.rect[i] = Layout::Place(widgets[i]);
+    return rects;
+}
+
+constexpr WidgetRects widgetRects = PlaceWidgets();
+
 /**
- * @brief Get the Ctrl from the list for the specified Entity and Property
- * 
- * @param entity The ID of the Entity to fetch
- * @param property The ID of the Property to fetch
- * @return Ctrl& A reference to the found Ctrl
- * @remarks Not finding the Ctrl is reported as an error and the first Ctrl in the list is returned
+ * @brief The drawing state of the widgets
  */
-Ctrl& GetCtrl(EntityID entity, PropertyID property)
+Layout::WidgetState widgetStates[widgetCount];
+
+/**
+ * @brief The Properties displayed by the widgets, with the update rates worth drawing
+ */
+const Subscription subscriptions[] =
+{
+    { EntityID_LeftMotor,  PropertyID_Goal,     0 },
+    { EntityID_RightMotor, PropertyID_Goal,     0 },
+    { EntityID_RearMotor,  PropertyID_Goal,     0 },
+    { EntityID_LeftMotor,  PropertyID_RPM,      10 },
+    { EntityID_RightMotor, PropertyID_RPM,      10 },
+    { EntityID_RearMotor,  PropertyID_RPM,      10 },
+    { EntityID_LeftMotor,  PropertyID_Power,    10 },
+    { EntityID_RightMotor, PropertyID_Power,    10 },
+    { EntityID_RearMotor,  PropertyID_Power,    10 },
+    { EntityID_Head,       PropertyID_Goal,     0 },
+    { EntityID_Head,       PropertyID_Power,    10 },
+    { EntityID_Head,       PropertyID_Position, 10 },
+};
+
+/**
+ * @brief Find the highest Entity and Property IDs displayed by the widgets, bounding the index
+ */
+constexpr int MaxWidgetEntity()
+{
+    int m = 0;
+    for (const Widget& w : widgets)
+        m = w.entity > m ? w.entity : m;
+    return m;
+}
+constexpr int MaxWidgetProperty()
+{
+    int m = 0;
+    for (const Widget& w : widgets)
+        m = w.property > m ? w.property : m;
+    return m;
+}
+
+/**
+ * @brief Lookup table from Entity and Property IDs to the slot of their first widget in the list,
+ *      with each widget linked to the next showing the same Property
+ */
+struct WidgetIndex
 {
-    for (int i = 0; i < sizeof(ctrls) / sizeof(Ctrl); i++)
+    int8_t slot[MaxWidgetEntity() + 1][MaxWidgetProperty() + 1];
+    int8_t next[widgetCount];
+};
+
+/**
+ * @brief Build the WidgetIndex at compile time
+ * @remarks Labels (PropertyID_None) are not indexed, a slot of -1 means "not displayed"
+ */
+constexpr WidgetIndex BuildWidgetIndex()
+{
+    WidgetIndex index {};
+    for (int e = 0; e <= MaxWidgetEntity(); e++)
+        for (int p = 0; p <= MaxWidgetProperty(); p++)
+            index.slot[e][p] = -1;
+    // link in reverse so each chain runs in list order
+    for (int i = widgetCount - 1; i >= 0; i--)
     {
-        if (ctrls[i].entity == entity && ctrls[i].property == property)
-            return ctrls[i];
+        index.next[i] = -1;
+        if (widgets[i].property == PropertyID_None)
+            continue;
+        index.next[i] = index.slot[widgets[i].entity][widgets[i].property];
+        index.slot[widgets[i].entity][widgets[i].property] = i;
     }
-    // no match is an error! not fatal, but will cause problems
-    floge("Ctrl not found");
-    return ctrls[0];
+    return index;
+}
+
+constexpr WidgetIndex widgetIndex = BuildWidgetIndex();
+
+/**
+ * @brief Find the first slot in the widget list for the specified Entity and Property
+ * 
+ * @param entity The ID of the Entity to find
+ * @param property The ID of the Property to find
+ * @return int The index into widgets, or -1 if the Property is not displayed
+ */
+inline int FindWidget(EntityID entity, PropertyID property)
+{
+    if ((unsigned)entity > (unsigned)MaxWidgetEntity() || (unsigned)property > (unsigned)MaxWidgetProperty())
+        return -1;
+    return widgetIndex.slot[entity][property];
 }
 
-const int8_t telMargin = 3; // the region margin used to compute the location values in the Ctrl list
+// the slot of the widget displaying the ControlMode
+constexpr int modeWidget = widgetIndex.slot[EntityID_None][PropertyID_ControlMode];
+static_assert(modeWidget >= 0, "no ControlMode widget");
+
+// the label and text color displaying each of the ControlModes
+// matching, in order, with their ControlModes values
+const char* const modeLabels[] = { "Disabled", "Unlimited", "Limited" };
+const uint16_t modeColors[] = { HX8357_RED, HX8357_YELLOW, HX8357_GREEN };
 
 /**
- * @brief Draw a given Ctrl
+ * @brief Draw the ControlMode widget for a mode
  * 
- * @param ctrl A reference to the Ctrl to draw
+ * @param mode The ControlMode shown
+ * @param full true to draw the whole widget rather than just the changed text
  */
-void DrawCtrl(Ctrl& ctrl)
+void DrawMode(int16_t mode, bool full)
 {
-    int16_t x = ctrl.location.x;
-    int16_t y = ctrl.location.y;
-    tft.setCursor(x, y + 1);
-    // clear the region
-    tft.fillRect(x-telMargin, y-telMargin, ctrl.width * charWidth + telMargin*2, charHeight + telMargin*2, RGBto565(54,54,54));
-    tft.setTextColor(ctrl.textColor);
-    if (ctrl.label != nullptr)
+    const Widget& w = widgets[modeWidget];
+    const Layout::Rect& r = widgetRects.rect[modeWidget];
+    Layout::WidgetState& s = widgetStates[modeWidget];
+    if (mode < Control_Disabled || mode > Control_Limited)
+        return;
+    if (full)
+        Layout::Draw(w, r, s, 0);
+    // the color differs for each mode, so all the characters are redrawn
+    Layout::DrawText(w, r, s, modeLabels[mode], modeColors[mode], true);
+}
+
+/**
+ * @brief Get the current value for a widget, from the State snapshot
+ */
+inline int16_t WidgetValue(const Widget& w)
+{
+    return w.property == PropertyID_None ? 0 : State::Get(w.entity, w.property);
+}
+
+/**
+ * @brief Chart of Goal vs RPM for a motor, placed on the Layout grid below the widgets
+ */
+History::Chart chart =
+{
+    Layout::Place({ Layout::Widget_Sparkline, 1, 7, 38, 2, 0, EntityID_None, PropertyID_None, 0, 0, nullptr }),
+    -100, 100,
+    { 0, 1 },                           // Left Motor Goal, RPM
+    { HX8357_YELLOW, HX8357_CYAN },
+    History::Tier_Raw,
+};
+
+/**
+ * @brief Present the page, drawing only the widgets that differ from the screen
+ */
+void PresentTelemetry()
+{
+    int16_t values[widgetCount];
+    Scene::Begin(HX8357_BLACK);
+    for (int i = 0; i < widgetCount; i++)
     {
-        // print any supplied label text
-        tft.printf("%-.*s", ctrl.width, ctrl.label);
+        values[i] = WidgetValue(widgets[i]);
+        // the mode text and color are not the widget label, always draw it
+        if (i == modeWidget)
+            widgetStates[i].node = Scene::Place(widgetRects.rect[i], Scene::Unique());
+        else
+            Layout::Present(widgets[i], widgetRects.rect[i], widgetStates[i], values[i]);
     }
-    else
+    // the chart replays history, always draw it
+    Scene::Place(chart.rect, Scene::Unique());
+    Scene::End();
+    for (int i = 0; i < widgetCount; i++)
     {
-        // print an Entity Property value
-        tft.print(VirtualBot.GetEntityProperty(ctrl.entity, ctrl.property)->Get());
+        if (i == modeWidget)
+            DrawMode(values[i], true);
+        else
+            Layout::Show(widgets[i], widgetRects.rect[i], widgetStates[i], values[i]);
     }
-    // restore the default text color to be nice to other UI pages
-    tft.setTextColor(HX8357_WHITE);
+    History::DrawChart(chart);
 }
 
 /**
- * @brief Draw all the controls
+ * @brief Set the NavLights Animation, noting it in the log
  */
-void DrawTelemetry()
+void SetAnimation(int16_t animation)
 {
-    for (int i = 0; i < sizeof(ctrls) / sizeof(Ctrl); i++)
-    {
-        DrawCtrl(ctrls[i]);
-    }
+    Sync::Set(EntityID_NavLights, PropertyID_Animation, animation);
+    Format::Log(EntityID_NavLights, PropertyID_Animation, animation);
 }
 
 /**
- * @brief Draw a Ctrl cpecified by Entity and Property IDs
+ * @brief Update the widgets showing a Property
  * 
- * @param entity The Entity ID of the Ctrl
- * @param property The Property ID of the Ctrl
+ * @param entity The Entity ID
+ * @param property The Property ID
+ * @param v The new value
+ * @remarks Properties not displayed are quietly ignored
  */
-void DrawCtrl(EntityID entity, PropertyID property)
+void UpdateWidgets(EntityID entity, PropertyID property, int16_t v)
 {
-    Ctrl& ctrl = GetCtrl(entity, property);
-    DrawCtrl(ctrl);
+    for (int slot = FindWidget(entity, property); slot >= 0; slot = widgetIndex.next[slot])
+        Layout::Update(widgets[slot], widgetRects.rect[slot], widgetStates[slot], v);
 }
 
 void Activate()
 {
     active = true;
-    tft.fillRect(0, 0, tftWidth, menuY, HX8357_BLACK);
-    DrawTelemetry();
+    Sync::Subscribe(subscriptions, sizeof(subscriptions) / sizeof(Subscription));
+    PresentTelemetry();
 }
 
 void Deactivate()
@@ -226,41 +357,71 @@ void Deactivate()
     active = false;
 }
 
+void ProcessHistory(uint8_t tiers)
+{
+    if (active && (tiers & (1 << chart.tier)) != 0)
+        History::UpdateChart(chart);
+}
+
+void ProcessChartKey(PadKeys btn, int16_t x, int16_t y)
+{
+    if (btn != PadKeys_l1 && btn != PadKeys_l2)
+        return;
+    // L1 cycles the motor charted, L2 cycles the chart tier (when pressed)
+    if (x != 0 && !chartKeyDown)
+    {
+        if (btn == PadKeys_l1)
+        {
+            chart.series[0] = (chart.series[0] + 2) % History::seriesCount;
+            chart.series[1] = chart.series[0] + 1;
+        }
+        else
+        {
+            chart.tier = (History::Tiers)((chart.tier + 1) % History::Tier_Count);
+        }
+        if (active)
+            History::DrawChart(chart);
+    }
+    // the analog L buttons report every pressure change, so track the press
+    chartKeyDown = x != 0;
+}
+
 void ProcessKey(PadKeys btn, int16_t x, int16_t y)
 {
+    // the chart keys are the UI page's
+    if (btn == PadKeys_l1 || btn == PadKeys_l2)
+        return;
+
     if (btn == PadKeys_start)
     {
         // the start button cycles through the ControlModes (when pressed)
         if (x != 0) // ignore the release
         {
-            Ctrl& ctrl = GetCtrl(EntityID_None, PropertyID_ControlMode);
             switch (ControlMode)
             {
             case Control_Disabled:
                 ControlMode = Control_Unlimited;
-                ctrl.textColor = HX8357_YELLOW;
-                ctrl.label = "Unlimited";
-                factorMode = 1;
                 break;
             case Control_Unlimited:
                 ControlMode = Control_Limited;
-                ctrl.textColor = HX8357_GREEN;
-                ctrl.label = "Limited";
-                factorMode = 0.5f;
                 break;
             case Control_Limited:
                 ControlMode = Control_Disabled;
-                ctrl.textColor = HX8357_RED;
-                ctrl.label = "Disabled";
-                factorMode = 0;
                 break;
             }
-            if (active)
-                DrawCtrl(ctrl);
+            UpdateGains();
         }
         return;
     }
 
+    if (btn == PadKeys_knob3Btn)
+    {
+        // the knob 3 button cycles through the control Profiles (when pressed)
+        if (x != 0)
+            Profiles::Select((Profiles::Active() + 1) % Profiles::Count());
+        return;
+    }
+
     if (ControlMode != Control_Disabled)
     {
         // robot control is enabled
@@ -268,40 +429,35 @@ void ProcessKey(PadKeys btn, int16_t x, int16_t y)
         {
         case PadKeys_cross:
             // kill all motor movement
-            for (EntityID m = EntityID_LeftMotor; m <= EntityID_RearMotor; m++)
-                VirtualBot.SetEntityPropertyValue(m, PropertyID_Goal, 0);
+            Arbiter::Stop();
             for (PadKeys k = PadKeys_knob0; k <= PadKeys_knob3; k++)
                 Pad::SetKnobValue(k, 0);
             break;
         case PadKeys_leftStick:
             // 'translate' in a vector corresponding to the left stick position
-            velOx = x * factorTrans * factorMode;
-            velOy = y * factorTrans * factorMode;
-            Guidance();
+            Arbiter::Demand(Arbiter::Source_LeftStick, Arbiter::Axis_X, x * gainTrans);
+            Arbiter::Demand(Arbiter::Source_LeftStick, Arbiter::Axis_Y, y * gainTrans);
             break;
         case PadKeys_rightStick:
             // 'tractor' x controls spin and y controls y movement (much like normal car driving)
-            velOw = -x * factorSpinT * factorMode;
-            velOy = y * factorTrans * factorMode;
-            Guidance();
+            Arbiter::Demand(Arbiter::Source_RightStick, Arbiter::Axis_W, -x * gainSpinT);
+            Arbiter::Demand(Arbiter::Source_RightStick, Arbiter::Axis_Y, y * gainTrans);
             break;
         case PadKeys_left:
             // 'spin' left
-            velOw = x * factorSpin * factorMode;
-            Guidance();
+            Arbiter::Demand(Arbiter::Source_DPad, Arbiter::Axis_W, x * gainSpin);
             break;
         case PadKeys_right:
             // 'spin' right
-            velOw = -x * factorSpin * factorMode;
-            Guidance();
+            Arbiter::Demand(Arbiter::Source_DPad, Arbiter::Axis_W, -x * gainSpin);
             break;
         case PadKeys_up:
             // head up while pressed
-            VirtualBot.SetEntityPropertyValue(EntityID_Head, PropertyID_Goal, (int16_t)roundf(x * 100.0f) / 255.0f);
+            Arbiter::Demand(Arbiter::Source_DPad, Arbiter::Axis_Head, (int16_t)roundf(x * 100.0f) / 255.0f);
             break;
         case PadKeys_down:
             // head down while pressed
-            VirtualBot.SetEntityPropertyValue(EntityID_Head, PropertyID_Goal, -(int16_t)roundf(x * 100.0f) / 255.0f);
+            Arbiter::Demand(Arbiter::Source_DPad, Arbiter::Axis_Head, -(int16_t)roundf(x * 100.0f) / 255.0f);
             break;
         case PadKeys_knob0Btn:
         case PadKeys_knob1Btn:
@@ -310,29 +466,25 @@ void ProcessKey(PadKeys btn, int16_t x, int16_t y)
             {
                 // when pressed, zeroes the corresponding motor goal
                 int ix = btn - PadKeys_knob0Btn;
-                VirtualBot.SetEntityPropertyValue((EntityID)(EntityID_LeftMotor + ix), PropertyID_Goal, 0);
+                Arbiter::Latch(ix, 0);
                 Pad::SetKnobValue((PadKeys)(PadKeys_knob0 + ix), 0);
             }
             break;
         case PadKeys_knob0:
         case PadKeys_knob1:
         case PadKeys_knob2:
-            {
-                // when set, controls the corresponding motor goal
-                // UNDONE: these knob controls can interfere or confuse the stick/button controls
-                //      Need a way to disconnect the two, but the knobs are mostly for testing
-                EntityID entity = (EntityID)(EntityID_LeftMotor + (btn - PadKeys_knob0));
-                VirtualBot.SetEntityPropertyValue(entity, PropertyID_Goal, (int8_t)x);
-            }
+            // when set, latches the corresponding motor goal, unless the sticks own the wheels
+            if (!Arbiter::Latch(btn - PadKeys_knob0, (int8_t)x))
+                Pad::SetKnobValue(btn, 0);
             break;
         case PadKeys_triangle:
-            VirtualBot.SetEntityPropertyValue(EntityID_NavLights, PropertyID_Animation, Animation_Fwd);
+            SetAnimation(Animation_Fwd);
             break;
         case PadKeys_r1:
-            VirtualBot.SetEntityPropertyValue(EntityID_NavLights, PropertyID_Animation, Animation_Green);
+            SetAnimation(Animation_Green);
             break;
         case PadKeys_r2:
-            VirtualBot.SetEntityPropertyValue(EntityID_NavLights, PropertyID_Animation, Animation_Cylon);
+            SetAnimation(Animation_Cylon);
             break;
         }
     }
@@ -347,7 +499,7 @@ void ProcessKey(PadKeys btn, int16_t x, int16_t y)
             {
                 // while disabled, force knob to stay at current goals
                 EntityID entity = (EntityID)(EntityID_LeftMotor + btn - PadKeys_knob0);
-                int8_t goal = VirtualBot.GetEntityPropertyValue(entity, PropertyID_Goal);
+                int8_t goal = Sync::Value(entity, PropertyID_Goal);
                 Pad::SetKnobValue(btn, goal);
             }
             break;    
@@ -355,31 +507,38 @@ void ProcessKey(PadKeys btn, int16_t x, int16_t y)
     }
 }
 
-void ProcessChange(Entity* pe, Property* pp)
-{
-    //flogd("%s.%s -> %i", pe->GetName(), pp->GetName(), pp->Get());
-    DrawCtrl(pe->GetID(), pp->GetID());
-}
-
-/**
- * @brief Plot a value for a given Entity and Property
- * 
- * @param entity The ID for the Entity
- * @param property The ID for the Property
- * @remarks Serial prints the name and value for use by the Teleplot VS Code extension
- */
-void PlotEntityProperty(EntityID entity, PropertyID property)
+void Loop()
 {
-    Property* pp = VirtualBot.GetEntityProperty(entity, property);
-    plot(VirtualBot.GetEntity(entity)->GetName(), pp->GetName(), pp->Get());
+    Arbiter::Command cmd;
+    if (!Arbiter::Resolve(cmd))
+        return;
+    if (cmd.unlatched)
+    {
+        // the knobs no longer hold the goals they show
+        for (PadKeys k = PadKeys_knob0; k <= PadKeys_knob2; k++)
+            Pad::SetKnobValue(k, 0);
+    }
+    if (cmd.guided)
+    {
+        velOx = cmd.v[Arbiter::Axis_X];
+        velOy = cmd.v[Arbiter::Axis_Y];
+        velOw = cmd.v[Arbiter::Axis_W];
+        Guidance();
+    }
+    else
+    {
+        Sync::Set(EntityID_LeftMotor, PropertyID_Goal, cmd.goals[0]);
+        Sync::Set(EntityID_RightMotor, PropertyID_Goal, cmd.goals[1]);
+        Sync::Set(EntityID_RearMotor, PropertyID_Goal, cmd.goals[2]);
+    }
+    Sync::Set(EntityID_Head, PropertyID_Goal, cmd.v[Arbiter::Axis_Head]);
 }
 
-void DoPlot()
+void ProcessChange(EntityID entity, PropertyID property, int16_t v)
 {
-    for (EntityID entity = EntityID_LeftMotor; entity <= EntityID_RearMotor; entity++)
-    {
-        PlotEntityProperty(entity, PropertyID_Goal);
-        PlotEntityProperty(entity, PropertyID_RPM);
-    }
+    if (entity == EntityID_None && property == PropertyID_ControlMode)
+        DrawMode(v, false);
+    else
+        UpdateWidgets(entity, property, v);
 }
 };
@@ -0,0 +1,223 @@
+#include "Drive.h"
+#include "Sync.h"
+#include "Scene.h"
+#include <atomic>
+
+namespace Drive
+{
+const int16_t stickRadius = 90;     // the area of a virtual stick
+const int16_t dotRadius = 16;       // the stick knob
+const int16_t travel = stickRadius - dotRadius - 2; // knob movement for full deflection
+const int16_t stickY = 146;         // center y of the sticks
+const float smoothing = 0.35f;      // fraction of the way to the target moved each tick
+
+const Point modeAt = { 205, 56 };   // the upper left of the buttons
+const Point stopAt = { 205, 196 };
+const int16_t buttonWidth = 70;
+const int16_t buttonHeight = 40;
+
+const uint16_t stickColor = RGBto565(90, 90, 90);
+const uint16_t dotColor = HX8357_CYAN;
+
+/**
+ * @brief A virtual joystick
+ */
+struct Stick
+{
+    PadKeys key;        // the PSX stick it stands in for
+    Point center;       // screen center
+    Point target;       // the touched deflection [-100..100], y positive up
+    float smoothX;      // smoothed deflection
+    float smoothY;
+    Point out;          // the deflection last reported, by the control task, and drawn by the UI
+    Point dot;          // the screen location of the knob drawn
+};
+
+Stick sticks[2] =
+{
+    { PadKeys_leftStick,  { 110, stickY } },
+    { PadKeys_rightStick, { 370, stickY } },
+};
+
+Adafruit_GFX_Button btnMode;    // stands in for Start
+Adafruit_GFX_Button btnStop;    // stands in for Cross
+
+bool active = false;
+Stick* dragged = nullptr;       // the stick being dragged
+portMUX_TYPE stickMux = portMUX_INITIALIZER_UNLOCKED;  // target and out are shared by the UI and control tasks
+std::atomic<bool> havePress(false); // a button press is waiting for the control task to report
+PadKeys press;                  // the button pressed
+
+/**
+ * @brief Compute the knob location for a stick deflection
+ */
+Point DotLocation(const Stick& stick)
+{
+    portENTER_CRITICAL(&stickMux);
+    Point out = stick.out;
+    portEXIT_CRITICAL(&stickMux);
+    return { (int16_t)(stick.center.x + out.x * travel / 100), (int16_t)(stick.center.y - out.y * travel / 100) };
+}
+
+/**
+ * @brief Draw a stick's knob where its deflection puts it, erasing the old knob
+ */
+void DrawDot(Stick& stick, bool erase)
+{
+    Point pt = DotLocation(stick);
+    if (erase)
+    {
+        if (pt.x == stick.dot.x && pt.y == stick.dot.y)
+            return;
+        tft.fillCircle(stick.dot.x, stick.dot.y, dotRadius, HX8357_BLACK);
+        // restore the center mark if the knob covered it
+        if (abs(stick.dot.x - stick.center.x) <= dotRadius && abs(stick.dot.y - stick.center.y) <= dotRadius)
+            tft.drawCircle(stick.center.x, stick.center.y, 3, stickColor);
+    }
+    stick.dot = pt;
+    tft.fillCircle(pt.x, pt.y, dotRadius, dotColor);
+}
+
+/**
+ * @brief Draw a whole stick
+ */
+void DrawStick(Stick& stick)
+{
+    tft.drawCircle(stick.center.x, stick.center.y, stickRadius, stickColor);
+    tft.drawCircle(stick.center.x, stick.center.y, 3, stickColor);
+    DrawDot(stick, false);
+}
+
+/**
+ * @brief Set a stick's target deflection, for the control task to follow
+ */
+void Aim(Stick& stick, Point target)
+{
+    portENTER_CRITICAL(&stickMux);
+    stick.target = target;
+    portEXIT_CRITICAL(&stickMux);
+}
+
+void Activate()
+{
+    active = true;
+    // the robot is driven, not watched
+    Sync::Subscribe(nullptr, 0);
+    // the knobs move, so the page is always drawn, but only its own area is cleared
+    Scene::Begin(HX8357_BLACK);
+    for (Stick& stick : sticks)
+        Scene::Place({ (int16_t)(stick.center.x - stickRadius), (int16_t)(stick.center.y - stickRadius), stickRadius * 2 + 1, stickRadius * 2 + 1 }, Scene::Unique());
+    Scene::Place({ modeAt.x, modeAt.y, buttonWidth, buttonHeight }, Scene::Unique());
+    Scene::Place({ stopAt.x, stopAt.y, buttonWidth, buttonHeight }, Scene::Unique());
+    Scene::End();
+    for (Stick& stick : sticks)
+        DrawStick(stick);
+    btnMode.initButtonUL(&tft, modeAt.x, modeAt.y, buttonWidth, buttonHeight, HX8357_WHITE, RGBto565(0x50,0x50,0x50), HX8357_YELLOW, (char*)"MODE", 2);
+    btnStop.initButtonUL(&tft, stopAt.x, stopAt.y, buttonWidth, buttonHeight, HX8357_WHITE, HX8357_RED, HX8357_WHITE, (char*)"STOP", 2);
+    btnMode.drawButton();
+    btnStop.drawButton();
+}
+
+void Deactivate()
+{
+    active = false;
+    // let go of the sticks, Loop brings them back to center
+    dragged = nullptr;
+    for (Stick& stick : sticks)
+        Aim(stick, { 0, 0 });
+}
+
+/**
+ * @brief Set a stick's target deflection from a touch point, limited to its circle
+ */
+void SetTarget(Stick& stick, int16_t x, int16_t y)
+{
+    int32_t dx = x - stick.center.x;
+    int32_t dy = stick.center.y - y;
+    int32_t len2 = dx * dx + dy * dy;
+    if (len2 > (int32_t)travel * travel)
+    {
+        float scale = travel / sqrtf(len2);
+        dx = dx * scale;
+        dy = dy * scale;
+    }
+    Aim(stick, { (int16_t)(dx * 100 / travel), (int16_t)(dy * 100 / travel) });
+}
+
+void ProcessTouch(const TouchEvent& e)
+{
+    switch (e.gesture)
+    {
+    case Touch_Tap:
+    case Touch_LongPress:
+        if (btnStop.contains(e.x, e.y))
+        {
+            press = PadKeys_cross;
+            havePress = true;
+        }
+        else if (btnMode.contains(e.x, e.y) && e.gesture == Touch_Tap)
+        {
+            press = PadKeys_start;
+            havePress = true;
+        }
+        break;
+    case Touch_DragStart:
+        // the drag belongs to the stick where the touch started
+        dragged = nullptr;
+        for (Stick& stick : sticks)
+        {
+            int16_t sx = e.x - e.dx - stick.center.x;
+            int16_t sy = e.y - e.dy - stick.center.y;
+            if ((int32_t)sx * sx + (int32_t)sy * sy <= (int32_t)stickRadius * stickRadius)
+                dragged = &stick;
+        }
+        // fall through
+    case Touch_Drag:
+        if (dragged != nullptr)
+            SetTarget(*dragged, e.x, e.y);
+        break;
+    case Touch_DragEnd:
+        // spring back to center
+        if (dragged != nullptr)
+            Aim(*dragged, { 0, 0 });
+        dragged = nullptr;
+        break;
+    }
+}
+
+void Loop(pad_cb func)
+{
+    if (havePress)
+    {
+        // press and release
+        havePress = false;
+        (*func)(press, 0xFF, 0);
+        (*func)(press, 0, 0);
+    }
+    for (Stick& stick : sticks)
+    {
+        portENTER_CRITICAL(&stickMux);
+        Point target = stick.target;
+        Point last = stick.out;
+        portEXIT_CRITICAL(&stickMux);
+        stick.smoothX += (target.x - stick.smoothX) * smoothing;
+        stick.smoothY += (target.y - stick.smoothY) * smoothing;
+        Point out = { (int16_t)roundf(stick.smoothX), (int16_t)roundf(stick.smoothY) };
+        if (out.x == last.x && out.y == last.y)
+            continue;
+        portENTER_CRITICAL(&stickMux);
+        stick.out = out;
+        portEXIT_CRITICAL(&stickMux);
+        (*func)(stick.key, out.x, out.y);
+    }
+}
+
+void Render()
+{
+    if (!active)
+        return;
+    for (Stick& stick : sticks)
+        DrawDot(stick, true);
+}
+
+};
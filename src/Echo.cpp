@@ -1,5 +1,10 @@
 #include "Echo.h"
 #include "FLogger.h"
+#include "Sync.h"
+#include "Scene.h"
+#include "Text.h"
+#include "Assets.h"
+#include "Format.h"
 
 namespace Echo
 {
@@ -11,6 +16,8 @@ uint16_t msgWidth = 13 * charWidth;
 uint16_t msgHeight = 2 * charHeight;
 uint16_t msgX = (tftWidth - msgWidth) / 2;
 uint16_t msgY = menuY - msgHeight;
+// width of the knob value areas across the top, one for each of the 4 knobs
+const uint16_t knobWidth = tftWidth / 4;
 
 // names for all the PSX buttons
 // matching, in order, with their PadKeys values
@@ -39,10 +46,10 @@ const char *const psxButtonNames[] =
 
 // inactive (untinted) button images
 // matching, in order, with their PadKeys values
-Adafruit_Image KeyImages[19];
+Assets::Image KeyImages[19];
 // active (red-tinted) button images
 // matching, in order, with their PadKeys values
-Adafruit_Image KeyImagesRed[19];
+Assets::Image KeyImagesRed[19];
 
 // locations, relative to the PSX image, for all the PSX buttons
 // matching, in order, with their PadKeys values
@@ -99,30 +106,27 @@ PadKeys ImageShareMap[] =
  * 
  * @param btn The PadKeys key
  * @param red true to return the red-tinted (active) image
- * @return Adafruit_Image& The Key's image
- * @remarks Defers loading of the images until requested
+ * @return Assets::Image& The Key's image
+ * @remarks Defers finding the images until requested
  */
-Adafruit_Image& GetKeyImage(PadKeys btn, bool red)
+Assets::Image& GetKeyImage(PadKeys btn, bool red)
 {
-    // several images are identical and are shared to save memory and SD space
+    // several images are identical and are shared to save memory and flash space
     btn = ImageShareMap[(int)btn];
-	Adafruit_Image& img = red ? KeyImagesRed[btn] : KeyImages[btn];
-	if (img.getFormat() == IMAGE_NONE)
-	{
-		char name[20];
-		strcpy(name, "/");
-		strcat(name, psxButtonNames[btn]);
+    Assets::Image& img = red ? KeyImagesRed[btn] : KeyImages[btn];
+    if (img.width == 0)
+    {
+        char name[20];
+        strcpy(name, psxButtonNames[btn]);
         if (red)
-			strcat(name, "r");
-		strcat(name, ".bmp");
-		ImageReturnCode stat = reader.loadBMP(name, img);
-        if (stat != IMAGE_SUCCESS)
-            floge("image load failed: %i", stat);
-	}
-	return img;
+            strcat(name, "r");
+        if (!Assets::Find(name, img))
+            floge("image not found: %s", name);
+    }
+    return img;
 }
  
-Adafruit_Image imgPSXPad;   // the image of the PSX controller
+Assets::Image imgPSXPad;    // the image of the PSX controller
 
 /**
  * @brief Draw the image of a button
@@ -135,71 +139,80 @@ void DrawButton(PadKeys btn, bool red)
     if (btn >= PadKeys_knob0Btn)
         return;
     Point pt = KeyImageMap[(int)btn];
-    Adafruit_Image& img = GetKeyImage(btn, red);
-    if (img.getFormat() != IMAGE_NONE)
-        img.draw(tft, pt.x + padX, pt.y + padY);
+    Assets::Draw(GetKeyImage(btn, red), pt.x + padX, pt.y + padY);
+}
+
+/**
+ * @brief Put a lead and a value, right aligned in the Format number width
+ *
+ * @param buf Receives the text and a terminator
+ * @param lead The text before the value
+ * @param v The value
+ * @return char* The end of the text
+ */
+char* Put(char* buf, const char* lead, int16_t v)
+{
+    char num[Format::widthMax + 1];
+    size_t n = strlen(lead);
+    memcpy(buf, lead, n);
+    memcpy(buf + n, Format::Number(v, Format::numberWidth, num), Format::numberWidth + 1);
+    return buf + n + Format::numberWidth;
 }
 
 void ProcessKey(PadKeys btn, int16_t x, int16_t y)
 {
     bool zeroed = x == 0 && y == 0;
     DrawButton(btn, !zeroed);
+    char buf[16];
+    buf[0] = '\0';
     switch (btn)
     {
     case PadKeys_knob0:
     case PadKeys_knob1:
     case PadKeys_knob2:
     case PadKeys_knob3:
-        {
-            // echo the knob values on the top line below them
-            int16_t x = (btn - PadKeys_knob0) * menuItemWidth;
-            tft.fillRect(x, 1, menuItemWidth, charHeight, HX8357_BLUE);
-            tft.setCursor(x, 1);
-        }
+        // echo the knob values on the top line below them, leaving zeroed values blank
+        if (!zeroed)
+            Put(buf, "   ", x);
+        Text::Draw((btn - PadKeys_knob0) * knobWidth, 1, buf, knobWidth / charWidth, HX8357_WHITE, HX8357_BLUE);
         break;
     default:
         // echo button/joystick values in the 'msg' space
-        tft.fillRect(msgX, msgY, msgWidth, msgHeight, HX8357_BLUE);
-        tft.setCursor(msgX, msgY);
-        break;
-    }
-    tft.setTextSize(2);
-    tft.setTextColor(HX8357_WHITE);
-    // leave zeroed values blank
-    if (!zeroed)
-    {
-        switch (btn)
+        if (!zeroed)
         {
-        case PadKeys_leftStick:
-        case PadKeys_rightStick:
-            tft.printf("%4i    %4i", x, y);
-            break;
-        default:
-            tft.printf("    %4i    ", x);
-            break;
+            switch (btn)
+            {
+            case PadKeys_leftStick:
+            case PadKeys_rightStick:
+                Put(Put(buf, "", x), "    ", y);
+                break;
+            default:
+                strcpy(Put(buf, "    ", x), "    ");
+                break;
+            }
         }
+        Text::Draw(msgX, msgY, buf, msgWidth / charWidth, HX8357_WHITE, HX8357_BLUE);
+        break;
     }
 }
 
 void Activate()
 {
-    // clear the screen, preserving the menu buttons
-    tft.fillRect(0, 0, tftWidth, menuY, HX8357_BLUE);
-    // load the PSX image
-	if (imgPSXPad.getFormat() == IMAGE_NONE)
-	{
-		ImageReturnCode stat = reader.loadBMP("/psxpad.bmp", imgPSXPad);
-        if (stat != IMAGE_SUCCESS)
-        {
-            floge("image load failed: %i", stat);
-            return;
-        }
-	}
+    // no robot telemetry is shown
+    Sync::Subscribe(nullptr, 0);
+    // the page draws knob and button activity anywhere above the menu buttons
+    Scene::Opaque(HX8357_BLUE);
+    // find the PSX image
+    if (imgPSXPad.width == 0 && !Assets::Find("psxpad", imgPSXPad))
+    {
+        floge("image not found: %s", "psxpad");
+        return;
+    }
     // center the image in the area above the menu buttons
-    padX = (tftWidth - imgPSXPad.width()) / 2;
-    padY = menuY - imgPSXPad.height() - 4;
+    padX = (tftWidth - imgPSXPad.width) / 2;
+    padY = menuY - imgPSXPad.height - 4;
     // draw it
-    imgPSXPad.draw(tft, padX, padY);
+    Assets::Draw(imgPSXPad, padX, padY);
 }
 
 void Deactivate()
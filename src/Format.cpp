@@ -0,0 +1,118 @@
+#include "Format.h"
+#include "State.h"
+#include "NavLightsBase.h"
+#include "FLogger.h"
+
+namespace Format
+{
+/**
+ * @brief The name of an enum value
+ */
+struct Name
+{
+    int16_t value;
+    const char* name;
+};
+
+/**
+ * @brief The text of a Property's values
+ */
+struct Formatter
+{
+    const char* name;       // the Property name
+    const char* unit;       // the units, "" for none
+    uint8_t width;          // the natural width
+    const Name* names;      // the names of enum values, or nullptr for numbers
+    uint8_t nameCount;
+};
+
+const Name animationNames[] =
+{
+    { Animation_Fwd,   "Fwd" },
+    { Animation_Green, "Green" },
+    { Animation_Cylon, "Cylon" },
+};
+
+/**
+ * @brief The formatter of each Property, in PropertyID order
+ */
+const Formatter formatters[] =
+{
+    { "None",        "",    numberWidth, nullptr,        0 },
+    { "Goal",        "",    numberWidth, nullptr,        0 },
+    { "RPM",         "rpm", numberWidth, nullptr,        0 },
+    { "Power",       "%",   numberWidth, nullptr,        0 },
+    { "Position",    "",    numberWidth, nullptr,        0 },
+    { "Animation",   "",    5,           animationNames, sizeof(animationNames) / sizeof(Name) },
+    { "ControlMode", "",    numberWidth, nullptr,        0 },
+};
+
+static_assert(sizeof(formatters) / sizeof(Formatter) == propertyCount, "a formatter for each PropertyID");
+
+/**
+ * @brief The Entity names, in EntityID order
+ */
+const char* const entityNames[] = { "Controller", "LeftMotor", "RightMotor", "RearMotor", "Head", "NavLights" };
+
+static_assert(sizeof(entityNames) / sizeof(const char*) == entityCount, "a name for each EntityID");
+
+/**
+ * @brief The text of the precomputed numbers, built at compile time
+ */
+struct Numbers
+{
+    char text[numberMax - numberMin + 1][numberWidth + 1];
+
+    constexpr Numbers() : text()
+    {
+        for (int16_t v = numberMin; v <= numberMax; v++)
+            Int(v, text[v - numberMin], numberWidth);
+    }
+};
+
+constexpr Numbers numbers;
+
+const char* Number(int16_t v, uint8_t width, char* buf)
+{
+    if (width == numberWidth && v >= numberMin && v <= numberMax)
+        return numbers.text[v - numberMin];
+    Int(v, buf, min(width, widthMax));
+    return buf;
+}
+
+const char* Value(PropertyID property, int16_t v, uint8_t width, char* buf)
+{
+    if (property < propertyCount)
+    {
+        const Formatter& f = formatters[property];
+        for (uint8_t i = 0; i < f.nameCount; i++)
+        {
+            if (f.names[i].value == v)
+                return f.names[i].name;
+        }
+    }
+    return Number(v, width, buf);
+}
+
+uint8_t Width(PropertyID property)
+{
+    return property < propertyCount ? formatters[property].width : numberWidth;
+}
+
+const char* Unit(PropertyID property)
+{
+    return property < propertyCount ? formatters[property].unit : "";
+}
+
+void Log(EntityID entity, PropertyID property, int16_t v)
+{
+    char buf[widthMax + 1];
+    const char* text = Value(property, v, Width(property), buf);
+    // the value without its alignment
+    while (*text == ' ')
+        text++;
+    flogi("%s %s %s%s", entity < entityCount ? entityNames[entity] : "?",
+        property < propertyCount ? formatters[property].name : "?", text, Unit(property));
+}
+
+};
@@ -0,0 +1,223 @@
+#include "History.h"
+#include "State.h"
+
+namespace History
+{
+/**
+ * @brief The Entity Property recorded by a series
+ */
+struct Series
+{
+    EntityID entity;
+    PropertyID property;
+};
+
+// the recorded series, Goal then RPM for each motor so Goal vs RPM charts pair up
+const Series seriesList[seriesCount] =
+{
+    { EntityID_LeftMotor,  PropertyID_Goal },
+    { EntityID_LeftMotor,  PropertyID_RPM },
+    { EntityID_RightMotor, PropertyID_Goal },
+    { EntityID_RightMotor, PropertyID_RPM },
+    { EntityID_RearMotor,  PropertyID_Goal },
+    { EntityID_RearMotor,  PropertyID_RPM },
+};
+
+// ring capacities, in samples, for each tier
+const uint16_t tierMax[Tier_Count] = { 480, 480, 360 };
+
+int16_t rawRing[seriesCount][480];      // every sample
+Sample ring1s[seriesCount][480];        // 8 minutes of 1 second min/max
+Sample ring10s[seriesCount][360];       // an hour of 10 second min/max
+
+uint16_t head[Tier_Count];              // ring index of the newest sample in each tier
+uint16_t count[Tier_Count];             // samples held in each tier
+
+Sample acc1s[seriesCount];              // min/max accumulating for the current second
+Sample acc10s[seriesCount];             // min/max accumulating for the current 10 seconds
+uint8_t seconds = 0;                    // seconds accumulated into acc10s
+
+uint16_t interval = 1000 / rateDefault; // msec between raw samples
+unsigned long timeSampleLast = 0;
+unsigned long time1sLast = 0;
+
+void SetRate(uint8_t hz)
+{
+    hz = constrain(hz, 1, 50);
+    interval = 1000 / hz;
+}
+
+int Find(EntityID entity, PropertyID property)
+{
+    for (int i = 0; i < seriesCount; i++)
+    {
+        if (seriesList[i].entity == entity && seriesList[i].property == property)
+            return i;
+    }
+    return -1;
+}
+
+uint16_t Count(Tiers tier)
+{
+    return count[tier];
+}
+
+Sample Get(uint8_t series, Tiers tier, uint16_t age)
+{
+    uint16_t ix = (head[tier] + tierMax[tier] - age % tierMax[tier]) % tierMax[tier];
+    switch (tier)
+    {
+    case Tier_Raw:
+        return { rawRing[series][ix], rawRing[series][ix] };
+    case Tier_1s:
+        return ring1s[series][ix];
+    default:
+        return ring10s[series][ix];
+    }
+}
+
+/**
+ * @brief Advance a tier's ring to the next slot
+ *
+ * @param tier The tier
+ * @return uint16_t The index of the slot to fill
+ */
+uint16_t Advance(Tiers tier)
+{
+    head[tier] = (head[tier] + 1) % tierMax[tier];
+    if (count[tier] < tierMax[tier])
+        count[tier]++;
+    return head[tier];
+}
+
+/**
+ * @brief Merge a value range into an accumulator
+ *
+ * @param acc The accumulator
+ * @param s The range to merge
+ * @param first true if the accumulator is empty
+ */
+inline void Merge(Sample& acc, Sample s, bool first)
+{
+    if (first)
+    {
+        acc = s;
+        return;
+    }
+    acc.lo = min(acc.lo, s.lo);
+    acc.hi = max(acc.hi, s.hi);
+}
+
+uint8_t Loop()
+{
+    unsigned long msec = millis();
+    if (msec - timeSampleLast < interval)
+        return 0;
+    // the samples keep to their interval however long the UI loop rested, repeating the State,
+    // which the slower ticks of the idle power modes change no more often, a long gap starts over
+    timeSampleLast = msec - timeSampleLast > 1000 ? msec : timeSampleLast + interval;
+    msec = timeSampleLast;
+    uint8_t tiers = 1 << Tier_Raw;
+
+    // the first raw sample of each second starts a new accumulation
+    bool first = count[Tier_Raw] == 0 || msec - time1sLast >= 1000;
+    if (first && count[Tier_Raw] != 0)
+    {
+        // close out the previous second
+        time1sLast = msec;
+        uint16_t ix = Advance(Tier_1s);
+        tiers |= 1 << Tier_1s;
+        for (int i = 0; i < seriesCount; i++)
+        {
+            ring1s[i][ix] = acc1s[i];
+            Merge(acc10s[i], acc1s[i], seconds == 0);
+        }
+        if (++seconds == 10)
+        {
+            seconds = 0;
+            ix = Advance(Tier_10s);
+            tiers |= 1 << Tier_10s;
+            for (int i = 0; i < seriesCount; i++)
+                ring10s[i][ix] = acc10s[i];
+        }
+    }
+    else if (first)
+    {
+        time1sLast = msec;
+    }
+
+    uint16_t ix = Advance(Tier_Raw);
+    for (int i = 0; i < seriesCount; i++)
+    {
+        int16_t v = State::Get(seriesList[i].entity, seriesList[i].property);
+        rawRing[i][ix] = v;
+        Merge(acc1s[i], { v, v }, first);
+    }
+    return tiers;
+}
+
+const uint16_t gridColor = RGBto565(90, 90, 90);    // the zero line
+
+/**
+ * @brief Compute the y of a chart value
+ */
+int16_t ChartY(const Chart& chart, int16_t v)
+{
+    const Layout::Rect& r = chart.rect;
+    int16_t height = r.h - Layout::margin * 2;
+    v = constrain(v, chart.min, chart.max);
+    return r.y + Layout::margin + height - 1 - (int32_t)(v - chart.min) * (height - 1) / (chart.max - chart.min);
+}
+
+/**
+ * @brief Draw one chart column for a sample and clear the column ahead of it
+ *
+ * @param chart The chart
+ * @param age The sample age in the chart's tier
+ */
+void DrawColumn(Chart& chart, uint16_t age)
+{
+    const Layout::Rect& r = chart.rect;
+    int16_t top = r.y + Layout::margin;
+    int16_t height = r.h - Layout::margin * 2;
+    int16_t width = r.w - Layout::margin * 2;
+    int16_t x = r.x + Layout::margin + chart.column;
+    tft.drawFastVLine(x, top, height, Layout::panelColor);
+    if (chart.min < 0 && chart.max > 0)
+        tft.drawPixel(x, ChartY(chart, 0), gridColor);
+    for (int i = 0; i < 2; i++)
+    {
+        Sample s = Get(chart.series[i], chart.tier, age);
+        int16_t yhi = ChartY(chart, s.hi);
+        int16_t ylo = ChartY(chart, s.lo);
+        // join to the previous column to keep the trace continuous
+        if (chart.column != 0)
+        {
+            yhi = min(yhi, chart.plotY[i]);
+            ylo = max(ylo, chart.plotY[i]);
+        }
+        tft.drawFastVLine(x, yhi, ylo - yhi + 1, chart.colors[i]);
+        chart.plotY[i] = ChartY(chart, s.hi);
+    }
+    chart.column = (chart.column + 1) % width;
+    tft.drawFastVLine(r.x + Layout::margin + chart.column, top, height, HX8357_BLACK);
+}
+
+void DrawChart(Chart& chart)
+{
+    const Layout::Rect& r = chart.rect;
+    tft.fillRect(r.x, r.y, r.w, r.h, Layout::panelColor);
+    int16_t width = r.w - Layout::margin * 2;
+    // replay as much of the stored history as fits, leaving the sweep gap
+    uint16_t n = min((int)count[chart.tier], width - 1);
+    chart.column = 0;
+    for (int age = n - 1; age >= 0; age--)
+        DrawColumn(chart, age);
+}
+
+void UpdateChart(Chart& chart)
+{
+    DrawColumn(chart, 0);
+}
+
+};
@@ -0,0 +1,312 @@
+#include "Layout.h"
+#include "Scene.h"
+#include "Text.h"
+#include "Format.h"
+
+namespace Layout
+{
+static_assert(textMax <= Format::widthMax, "text widgets within the Format width");
+
+/**
+ * @brief Get the text of a value for a text widget, right aligned in its width
+ *
+ * @param buf Receives the text when it is not precomputed
+ */
+inline const char* ValueText(const Widget& w, int16_t v, char* buf)
+{
+    return Format::Value(w.property, v, min(w.cols, textMax), buf);
+}
+
+/**
+ * @brief Compute the Scene key for text characters
+ *
+ * @param chars The characters, padded to the widget width
+ * @param n The character count
+ * @param color The text color
+ */
+uint32_t CharsKey(const char* chars, uint8_t n, uint16_t color)
+{
+    return Scene::Hash(Scene::Hash(Scene::hashSeed, &color, sizeof(color)), chars, n);
+}
+
+/**
+ * @brief Copy text, padded with spaces to the widget width as DrawText shows it
+ *
+ * @return uint8_t The character count
+ */
+uint8_t PadText(const Widget& w, const char* text, char* buf)
+{
+    uint8_t n = w.cols < textMax ? w.cols : textMax;
+    bool ended = false;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (!ended && text[i] == '\0')
+            ended = true;
+        buf[i] = ended ? ' ' : text[i];
+    }
+    return n;
+}
+
+void DrawText(const Widget& w, const Rect& r, WidgetState& s, const char* text, uint16_t color, bool force)
+{
+    char buf[textMax + 1];
+    uint8_t n = PadText(w, text, buf);
+    int16_t x = r.x + margin;
+    int16_t y = r.y + margin + 1;
+    // draw each run of changed characters in one burst
+    for (uint8_t i = 0; i < n; )
+    {
+        if (!force && s.text[i] == buf[i])
+        {
+            i++;
+            continue;
+        }
+        uint8_t run = i;
+        while (run < n && (force || s.text[run] != buf[run]))
+        {
+            s.text[run] = buf[run];
+            run++;
+        }
+        Text::Draw(x + i * charWidth, y, &buf[i], run - i, color, panelColor);
+        i = run;
+    }
+    Scene::Rekey(s.node, CharsKey(s.text, n, color));
+}
+
+/**
+ * @brief Compute the pixel span of a bar for a value
+ *
+ * @param w The widget
+ * @param r The widget rectangle
+ * @param v The value
+ * @param lo Receives the left end of the span
+ * @param hi Receives the right end of the span (exclusive)
+ */
+void BarSpan(const Widget& w, const Rect& r, int16_t v, int16_t& lo, int16_t& hi)
+{
+    int16_t left = r.x + margin;
+    int16_t width = r.w - margin * 2;
+    v = constrain(v, w.min, w.max);
+    // bars grow from zero when the range spans it, otherwise from the left end
+    int16_t z = (w.min < 0 && w.max > 0) ? left + (int32_t)(0 - w.min) * width / (w.max - w.min) : left;
+    int16_t p = left + (int32_t)(v - w.min) * width / (w.max - w.min);
+    lo = min(z, p);
+    hi = max(z, p);
+}
+
+/**
+ * @brief Fill a span of the bar area
+ */
+inline void FillBar(const Rect& r, int16_t from, int16_t to, uint16_t color)
+{
+    if (to > from)
+        tft.fillRect(from, r.y + margin, to - from, r.h - margin * 2, color);
+}
+
+/**
+ * @brief Draw a new bar value, filling or clearing only the ends that moved
+ */
+void UpdateBar(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    int16_t lo, hi;
+    BarSpan(w, r, v, lo, hi);
+    if (lo < s.lo)
+        FillBar(r, lo, s.lo, w.color);
+    else
+        FillBar(r, s.lo, lo, panelColor);
+    if (hi > s.hi)
+        FillBar(r, s.hi, hi, w.color);
+    else
+        FillBar(r, hi, s.hi, panelColor);
+    s.lo = lo;
+    s.hi = hi;
+}
+
+/**
+ * @brief Compute the y of a sparkline value
+ */
+int16_t PlotY(const Widget& w, const Rect& r, int16_t v)
+{
+    int16_t height = r.h - margin * 2;
+    v = constrain(v, w.min, w.max);
+    return r.y + margin + height - 1 - (int32_t)(v - w.min) * (height - 1) / (w.max - w.min);
+}
+
+/**
+ * @brief Add a sparkline value, sweeping left to right
+ * @remarks Only the column for the new value and the gap ahead of it are redrawn
+ */
+void UpdateSparkline(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    int16_t top = r.y + margin;
+    int16_t height = r.h - margin * 2;
+    int16_t width = r.w - margin * 2;
+    int16_t x = r.x + margin + s.column;
+    int16_t y = PlotY(w, r, v);
+    tft.drawFastVLine(x, top, height, panelColor);
+    if (s.column == 0)
+        tft.drawPixel(x, y, w.color);
+    else
+        tft.drawFastVLine(x, min(y, s.plotY), abs(y - s.plotY) + 1, w.color);
+    // clear ahead to mark the sweep position
+    s.column = (s.column + 1) % width;
+    tft.drawFastVLine(r.x + margin + s.column, top, height, HX8357_BLACK);
+    s.plotY = y;
+}
+
+/**
+ * @brief Draw a lamp lit or unlit
+ */
+void DrawLamp(const Widget& w, const Rect& r, bool lit)
+{
+    int16_t radius = min(r.w, r.h) / 2 - margin;
+    tft.fillCircle(r.x + r.w / 2, r.y + r.h / 2, radius, lit ? w.color : HX8357_BLACK);
+}
+
+/**
+ * @brief Determine if a lamp is lit for a value
+ */
+inline bool LampLit(const Widget& w, int16_t v)
+{
+    return abs(v) >= w.min;
+}
+
+void Draw(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    tft.fillRect(r.x, r.y, r.w, r.h, panelColor);
+    memset(s.text, ' ', sizeof(s.text));
+    s.drawn = true;
+    s.value = v;
+    switch (w.kind)
+    {
+    case Widget_Label:
+        DrawText(w, r, s, w.label, w.color, false);
+        break;
+    case Widget_Text:
+        {
+            char buf[textMax + 1];
+            DrawText(w, r, s, ValueText(w, v, buf), w.color, false);
+        }
+        break;
+    case Widget_Bar:
+        // start from the empty bar
+        BarSpan(w, r, (w.min < 0 && w.max > 0) ? 0 : w.min, s.lo, s.hi);
+        UpdateBar(w, r, s, v);
+        Scene::Rekey(s.node, Key(w, r, v));
+        break;
+    case Widget_Sparkline:
+        s.column = 0;
+        UpdateSparkline(w, r, s, v);
+        break;
+    case Widget_Lamp:
+        DrawLamp(w, r, LampLit(w, v));
+        Scene::Rekey(s.node, Key(w, r, v));
+        break;
+    }
+}
+
+void Update(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    if (!s.drawn)
+    {
+        Draw(w, r, s, v);
+        return;
+    }
+    // the sparkline traces every sample, the rest only need changes
+    if (v == s.value && w.kind != Widget_Sparkline)
+        return;
+    int16_t prev = s.value;
+    s.value = v;
+    switch (w.kind)
+    {
+    case Widget_Label:
+        break;
+    case Widget_Text:
+        {
+            char buf[textMax + 1];
+            DrawText(w, r, s, ValueText(w, v, buf), w.color, false);
+        }
+        break;
+    case Widget_Bar:
+        UpdateBar(w, r, s, v);
+        Scene::Rekey(s.node, Key(w, r, v));
+        break;
+    case Widget_Sparkline:
+        UpdateSparkline(w, r, s, v);
+        break;
+    case Widget_Lamp:
+        if (LampLit(w, v) != LampLit(w, prev))
+        {
+            DrawLamp(w, r, LampLit(w, v));
+            Scene::Rekey(s.node, Key(w, r, v));
+        }
+        break;
+    }
+}
+
+uint32_t Key(const Widget& w, const Rect& r, int16_t v)
+{
+    char buf[textMax + 1];
+    uint16_t parts[4] = { (uint16_t)w.kind, w.color, 0, 0 };
+    switch (w.kind)
+    {
+    case Widget_Label:
+        return CharsKey(buf, PadText(w, w.label, buf), w.color);
+    case Widget_Text:
+        {
+            char text[textMax + 1];
+            return CharsKey(buf, PadText(w, ValueText(w, v, text), buf), w.color);
+        }
+    case Widget_Bar:
+        {
+            int16_t lo, hi;
+            BarSpan(w, r, v, lo, hi);
+            parts[2] = lo;
+            parts[3] = hi;
+        }
+        break;
+    case Widget_Lamp:
+        parts[2] = LampLit(w, v);
+        break;
+    case Widget_Sparkline:
+    default:
+        return Scene::Unique();
+    }
+    return Scene::Hash(Scene::hashSeed, parts, sizeof(parts));
+}
+
+void Present(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    s.node = Scene::Place(r, Key(w, r, v));
+}
+
+void Show(const Widget& w, const Rect& r, WidgetState& s, int16_t v)
+{
+    if (Scene::Dirty(s.node))
+    {
+        Draw(w, r, s, v);
+        return;
+    }
+    // the screen already shows it, just remember what is there
+    s.drawn = true;
+    s.value = v;
+    switch (w.kind)
+    {
+    case Widget_Label:
+        PadText(w, w.label, s.text);
+        break;
+    case Widget_Text:
+        {
+            char buf[textMax + 1];
+            PadText(w, ValueText(w, v, buf), s.text);
+        }
+        break;
+    case Widget_Bar:
+        BarSpan(w, r, v, s.lo, s.hi);
+        break;
+    default:
+        break;
+    }
+}
+
+};
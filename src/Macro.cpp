@@ -0,0 +1,218 @@
+#include "Macro.h"
+#include "Sync.h"
+#include "Arbiter.h"
+#include "FLogger.h"
+
+namespace Macro
+{
+const uint8_t waitKey = 0xFF;       // an event only carrying time, for long gaps and the end
+const uint8_t eventMax = 10;        // the most bytes an event can take: 3 varints and the key
+
+/**
+ * @brief A decoded event
+ */
+struct Event
+{
+    uint8_t btn;
+    int16_t x;
+    int16_t y;
+};
+
+uint8_t buffer[bufferMax];          // the recorded events
+uint16_t length = 0;                // bytes recorded
+
+bool recording = false;
+unsigned long timeLast = 0;         // millis() of the last event recorded
+
+bool playing = false;
+const uint8_t* next = nullptr;      // the next event to decode for playback
+unsigned long startMsec = 0;        // millis() playback started
+uint32_t dueMsec = 0;               // time of the pending event, from the start
+Event pending;                      // the event playback is waiting on
+
+bool squareDown = false;            // the analog buttons report every pressure change, so track presses
+bool circleDown = false;
+
+/**
+ * @brief Determine if a key carries a y value
+ */
+inline bool HasY(uint8_t btn)
+{
+    return btn == PadKeys_leftStick || btn == PadKeys_rightStick;
+}
+
+/**
+ * @brief Append an event to the recording
+ *
+ * @return false if the buffer is full
+ */
+bool Put(uint8_t btn, int16_t x, int16_t y)
+{
+    unsigned long msec = millis();
+    uint32_t delta = msec - timeLast;
+    timeLast = msec;
+    uint8_t* p = buffer + length;
+    // long gaps are carried by waits
+    while (delta > 0xFFFF)
+    {
+        if (length + eventMax > bufferMax)
+            return false;
+        Sync::PutVarint(p, 0xFFFF);
+        *p++ = waitKey;
+        length = p - buffer;
+        delta -= 0xFFFF;
+    }
+    if (length + eventMax > bufferMax)
+        return false;
+    Sync::PutVarint(p, delta);
+    *p++ = btn;
+    if (btn != waitKey)
+    {
+        Sync::PutVarint(p, Sync::ZigZag(x));
+        if (HasY(btn))
+            Sync::PutVarint(p, Sync::ZigZag(y));
+    }
+    length = p - buffer;
+    return true;
+}
+
+/**
+ * @brief Decode the next recorded event for playback into pending, advancing dueMsec
+ *
+ * @return false at the end of the recording
+ */
+bool Decode()
+{
+    const uint8_t* end = buffer + length;
+    uint16_t delta, x = 0, y = 0;
+    if (!Sync::GetVarint(next, end, delta) || next >= end)
+        return false;
+    pending.btn = *next++;
+    if (pending.btn != waitKey)
+    {
+        if (!Sync::GetVarint(next, end, x))
+            return false;
+        if (HasY(pending.btn) && !Sync::GetVarint(next, end, y))
+            return false;
+    }
+    pending.x = Sync::UnZigZag(x);
+    pending.y = Sync::UnZigZag(y);
+    dueMsec += delta;
+    return true;
+}
+
+/**
+ * @brief Start or stop recording
+ */
+void ToggleRecording()
+{
+    if (recording)
+    {
+        // the end carries the time to the stop, so playback lasts as long
+        Put(waitKey, 0, 0);
+        recording = false;
+        flogi("Macro recorded %u bytes", length);
+        return;
+    }
+    recording = true;
+    length = 0;
+    timeLast = millis();
+    flogi("Macro recording");
+}
+
+/**
+ * @brief Stop playback
+ */
+void Stop()
+{
+    playing = false;
+    // the replayed goals would otherwise hold, leaving the motors running
+    Arbiter::Stop();
+    flogi("Macro stopped");
+}
+
+/**
+ * @brief Start playback from the beginning
+ */
+void Play()
+{
+    next = buffer;
+    dueMsec = 0;
+    if (!Decode())
+    {
+        floge("Macro empty");
+        return;
+    }
+    startMsec = millis();
+    playing = true;
+    flogi("Macro playing %u bytes", length);
+}
+
+bool ProcessKey(PadKeys btn, int16_t x, int16_t y)
+{
+    switch (btn)
+    {
+    case PadKeys_square:
+        if (x != 0 && !squareDown && !playing)
+            ToggleRecording();
+        squareDown = x != 0;
+        return false;
+    case PadKeys_circle:
+        if (x != 0 && !circleDown && !recording)
+        {
+            if (playing)
+                Stop();
+            else
+                Play();
+        }
+        circleDown = x != 0;
+        return false;
+    default:
+        break;
+    }
+    if (playing)
+    {
+        // only stopping the motors overrides the test
+        if (btn != PadKeys_cross)
+            return false;
+        Stop();
+        return true;
+    }
+    if (recording && !Put(btn, x, y))
+    {
+        floge("Macro buffer full");
+        ToggleRecording();
+    }
+    return true;
+}
+
+void Loop(pad_cb func)
+{
+    if (!playing)
+        return;
+    // timed from the start so no error accumulates, and several events may be due at once
+    while (millis() - startMsec >= dueMsec)
+    {
+        if (pending.btn != waitKey)
+            (*func)((PadKeys)pending.btn, pending.x, pending.y);
+        if (!Decode())
+        {
+            playing = false;
+            Arbiter::Stop();
+            flogi("Macro done");
+            return;
+        }
+    }
+}
+
+bool Playing()
+{
+    return playing;
+}
+
+bool Recording()
+{
+    return recording;
+}
+
+};
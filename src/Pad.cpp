@@ -1,12 +1,21 @@
 #include "Pad.h"
+#ifdef PSX_SPI
+#include "PsxSpi.h"
+#else
 #include <PsxControllerBitBang.h>
+#endif
 #include "FLogger.h"
 #include "ScaledKnob.h"
 
 namespace Pad
 {
+#ifdef PSX_SPI
+// the PSX controller interfaced using the HSPI peripheral, the screen is on the default VSPI
+PsxControllerSpi psx(SPI2_HOST, PSX_ATT, PSX_CMD, PSX_DAT, PSX_CLK);
+#else
 // the PSX controller interfaced using bitbang (brute force IO pin method)
 PsxControllerBitBang<PSX_ATT, PSX_CMD, PSX_DAT, PSX_CLK> psx;
+#endif
 
 // PadKeys_select thru PadKeys_rightStick are all buttons we can detect
 // this maps them to their PsxAnalogButton values used by the PsxController library
@@ -39,17 +48,26 @@ int8_t analogBtnMap[] =
 Adafruit_seesaw SeeSaw;
 seesaw_NeoPixel SSPixel = seesaw_NeoPixel(4, 18, NEO_GRB + NEO_KHZ800);
 
-// interface to the knobs with value ranges we want
-// UNDONE: these might want to change in the future based on the active UI page?
+// interface to the knobs with their native value ranges
+// the active Profile scales these to the ranges reported
 ScaledKnob Knob0(0, 12, -100, 100, 5);
 ScaledKnob Knob1(1, 14, -100, 100, 5);
 ScaledKnob Knob2(2, 17, -100, 100, 5);
-ScaledKnob Knob3(3,  9, -255, 255, 5);  // currently unused
+ScaledKnob Knob3(3,  9, -255, 255, 5);  // value currently unused, the button cycles the Profiles
+ScaledKnob* const knobs[knobCount] = { &Knob0, &Knob1, &Knob2, &Knob3 };
+const int16_t knobNativeMin[knobCount] = { -100, -100, -100, -255 };
+const int16_t knobNativeMax[knobCount] = {  100,  100,  100,  255 };
+
+// knob scaling from native to reported values, from the active Profile
+float knobScale[knobCount] = { 1, 1, 1, 1 };
+float knobOffset[knobCount];
 
 // flag when controller has been found
 // initialization is deferred and recovery indicated when lost
-// a future feature could allow for a touchscreen robot control interface!
+// the touchscreen Drive page can control the robot without it
 bool haveController = false;
+const uint16_t retryMsec = 2000;    // msec between attempts to find the controller
+unsigned long timeRetryLast = 0;    // millis() of the last attempt
 
 /**
  * @brief Set analog mode for buttons and joysticks and lock to disable non-analog mode
@@ -66,6 +84,32 @@ void EnableAnalog()
         floge("Cannot exit config mode");
 }
 
+/**
+ * @brief Start reading the PSX controller
+ * @remarks On SPI the frame is polled in the background, to be taken by the next Read
+ */
+void StartRead()
+{
+#ifdef PSX_SPI
+    psx.StartRead();
+#endif
+}
+
+/**
+ * @brief Read the PSX controller's buttons and joysticks
+ *
+ * @return true if the controller answered
+ * @remarks On SPI the frame polled since the last control tick
+ */
+bool Read()
+{
+#ifdef PSX_SPI
+    return psx.FinishRead();
+#else
+    return psx.read();
+#endif
+}
+
 /**
  * @brief (re)Initialize the PSX controller
  */
@@ -76,8 +120,12 @@ void InitPSX()
         floge("Controller not found");
     else
         flogi("Controller found");
-    delay(300);
-    EnableAnalog();
+    // Loop enables analog again if the pad was not ready for it yet
+    if (haveController)
+    {
+        EnableAnalog();
+        StartRead();
+    }
 }
     
 void Init()
@@ -105,10 +153,31 @@ void Init()
 // matching, in order, with their PadKeys values
 Point currBtns[PadKeys_knob3-PadKeys_select+1];
 
-// joystick deadzone
-// this value is specifically chosen to make it easy to convert the
-// normal joystick range of [-128..127] to [-100..100] by just clipping out the deadzone
-const int16_t deadzone = 27;
+// joystick readings [0..255] to [-100..100] with the deadzone clipped out, from the active Profile
+int8_t stickMap[256];
+
+void SetProfile(const Profile& profile)
+{
+    // the deadzone is subtracted out and the rest scaled to [-100..100]
+    // the default deadzone (27) leaves the range unscaled
+    int16_t deadzone = constrain(profile.deadzone, 0, 100);
+    int16_t span = 127 - deadzone;
+    for (int raw = 0; raw < 256; raw++)
+    {
+        // convert to [-127..127]
+        int16_t v = raw - 128;
+        if (v == -128)
+            v = -127;
+        int16_t mag = abs(v) - deadzone;
+        mag = mag <= 0 ? 0 : (mag * 100 + span / 2) / span;
+        stickMap[raw] = v < 0 ? -mag : mag;
+    }
+    for (int i = 0; i < knobCount; i++)
+    {
+        knobScale[i] = (float)(profile.knobMax[i] - profile.knobMin[i]) / (knobNativeMax[i] - knobNativeMin[i]);
+        knobOffset[i] = profile.knobMin[i] - knobNativeMin[i] * knobScale[i];
+    }
+}
 
 /**
  * @brief Process a pair of new joystick values and compare against the saved values to detect a change
@@ -122,31 +191,9 @@ const int16_t deadzone = 27;
  */
 bool ProcessStickXY(Point &p, int16_t x, int16_t y)
 {
-    // convert [0..255]
-    // convert to [-127..127]
-    int16_t xx = x - 128;
-    if (xx == -128)
-        xx = -127;
-    int16_t yy = y - 128;      
-    if (yy == -128)
-        yy = -127;
     // flip the Y axes so that positive is up
-    yy = -yy;
-    // enforce a stick deadzone (27)
-    // subtracting it out, leaving values [-100..100]
-    // CONSIDER: just using map and constrain?
-    if (abs(xx) <= deadzone)
-        xx = 0;
-    else if (xx > 0)
-        xx -= deadzone;
-    else
-        xx += deadzone;
-    if (abs(yy) <= deadzone)
-        yy = 0;
-    else if (yy > 0)
-        yy -= deadzone;
-    else
-        yy += deadzone;
+    int16_t xx = stickMap[x & 0xFF];
+    int16_t yy = -stickMap[y & 0xFF];
     if (xx == p.x && yy == p.y)
         return false;
     p.x = xx;
@@ -193,16 +240,17 @@ bool processKnobBtn(ScaledKnob& knob, Point &p)
 /**
  * @brief Read a knob (rotary encoder) value and compare against the saved value to detect a change
  *
- * @param knob The knob to check
+ * @param index The knob to check
  * @param p A Point value pair representing the previous x value (y value ignored)
  * @return true if the value has changed
  * @return false if the value has not changed
  * @remarks Any value changes are saved back to the reference Point input
  */
-bool processKnob(ScaledKnob& knob, Point &p)
+bool processKnob(int index, Point &p)
 {
+    ScaledKnob& knob = *knobs[index];
     knob.Sample();
-    int16_t v = (int)roundf(knob.GetValue());
+    int16_t v = (int)roundf(knob.GetValue() * knobScale[index] + knobOffset[index]);
     if (v == p.x)
         return false;
     p.x = v;
@@ -217,21 +265,11 @@ bool processKnob(ScaledKnob& knob, Point &p)
  */
 void SetKnobValue(PadKeys btn, int16_t v)
 {
-    switch (btn)
-    {
-    case PadKeys_knob0:
-        Knob0.SetValue(v);
-        break;
-    case PadKeys_knob1:
-        Knob1.SetValue(v);
-        break;
-    case PadKeys_knob2:
-        Knob2.SetValue(v);
-        break;
-    case PadKeys_knob3:
-        Knob3.SetValue(v);
-        break;
-    }
+    if (btn < PadKeys_knob0 || btn > PadKeys_knob3)
+        return;
+    int index = btn - PadKeys_knob0;
+    if (knobScale[index] != 0)
+        knobs[index]->SetValue((v - knobOffset[index]) / knobScale[index]);
 }
 
 void Loop(pad_cb func)
@@ -239,12 +277,18 @@ void Loop(pad_cb func)
     // check/restore the PSX connection
     if (!haveController)
     {
+        // (re)initialization stalls the loop, so only retry occasionally
+        // while the touchscreen Drive page stands in for the controller
+        unsigned long msec = millis();
+        if (msec - timeRetryLast < retryMsec)
+            return;
+        timeRetryLast = msec;
         InitPSX();
         if (!haveController)
             return;
     }
     // poll the PSX to read its current button/joystick states
-    if (!psx.read())
+    if (!Read())
     {
         floge("Controller lost");
         haveController = false;
@@ -254,9 +298,12 @@ void Loop(pad_cb func)
         // make sure we're in analog mode!
         //flogi("anlog mode reenabled");
         EnableAnalog();
+        StartRead();
     }
     else
     {
+        // the next poll goes on while this one is processed and the control tick waits
+        StartRead();
         // process the new state of the PSX joysticks agains their last known state
         byte x, y;
         psx.getLeftAnalog(x, y);
@@ -298,13 +345,13 @@ void Loop(pad_cb func)
         (*func)(PadKeys_knob2Btn, currBtns[PadKeys_knob2Btn].x, 0);
     if (processKnobBtn(Knob3, currBtns[PadKeys_knob3Btn]))
         (*func)(PadKeys_knob3Btn, currBtns[PadKeys_knob3Btn].x, 0);
-    if (processKnob(Knob0, currBtns[PadKeys_knob0]))
+    if (processKnob(0, currBtns[PadKeys_knob0]))
         (*func)(PadKeys_knob0, currBtns[PadKeys_knob0].x, 0);
-    if (processKnob(Knob1, currBtns[PadKeys_knob1]))
+    if (processKnob(1, currBtns[PadKeys_knob1]))
         (*func)(PadKeys_knob1, currBtns[PadKeys_knob1].x, 0);
-    if (processKnob(Knob2, currBtns[PadKeys_knob2]))
+    if (processKnob(2, currBtns[PadKeys_knob2]))
         (*func)(PadKeys_knob2, currBtns[PadKeys_knob2].x, 0);
-    if (processKnob(Knob3, currBtns[PadKeys_knob3]))
+    if (processKnob(3, currBtns[PadKeys_knob3]))
         (*func)(PadKeys_knob3, currBtns[PadKeys_knob3].x, 0);
 }
 
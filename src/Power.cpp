@@ -0,0 +1,156 @@
+#include "Power.h"
+#include "PSXPad.h"
+#include "Sync.h"
+#include "FLogger.h"
+#include <atomic>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+namespace Power
+{
+const uint32_t idleMsec = 5000;     // msec without input before Idle
+const uint32_t sleepMsec = 60000;   // msec without input before Sleep
+
+/**
+ * @brief The settings of a power mode
+ * @remarks The current estimates are for the ESP32 module with the radio on, from its datasheet,
+ *      the screen backlight draws on top of them in every mode
+ */
+struct Setting
+{
+    const char* name;
+    uint16_t period;    // control tick period in msec
+    uint16_t rest;      // the longest UI rest in msec, between the control ticks
+    uint16_t mhz;       // CPU clock, no lower than the radio needs
+    uint16_t mA;        // estimated current
+};
+
+const Setting settings[] =
+{
+    //  name      period  rest  mhz  mA
+    { "active",     20,     5,  240, 130 },
+    { "idle",      100,   100,   80,  60 },
+    { "sleep",     250,   250,   80,   5 },
+};
+
+static_assert(sizeof(settings) / sizeof(Setting) == Mode_Count, "a Setting for each Mode");
+
+Modes mode = Mode_Active;
+std::atomic<uint32_t> activityLast(0);  // millis() of the last input
+std::atomic<bool> resting(false);       // the UI task is resting, not drawing
+TaskHandle_t uiTask = nullptr;
+uint32_t modeMsec[Mode_Count];          // time spent in each mode
+unsigned long timeWaitLast = 0;         // millis() at the last Wait
+
+void Init()
+{
+    uiTask = xTaskGetCurrentTaskHandle();
+    // the touchscreen interrupt, the SeeSaw and PSX have no interrupt wired and are polled
+    esp_sleep_enable_gpio_wakeup();
+    activityLast = millis();
+}
+
+void Activity()
+{
+    activityLast = millis();
+}
+
+void IRAM_ATTR WakeFromISR()
+{
+    if (uiTask == nullptr)
+        return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(uiTask, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+Modes Mode()
+{
+    return mode;
+}
+
+/**
+ * @brief Determine if the wheels are stopped, so the robot is safe to leave without its link
+ */
+bool Stopped()
+{
+    return Sync::Value(EntityID_LeftMotor, PropertyID_Goal) == 0
+        && Sync::Value(EntityID_RightMotor, PropertyID_Goal) == 0
+        && Sync::Value(EntityID_RearMotor, PropertyID_Goal) == 0;
+}
+
+/**
+ * @brief Step to the mode for the input activity
+ */
+void Step(unsigned long msec)
+{
+    uint32_t idle = msec - activityLast;
+    Modes next = Mode_Active;
+    if (idle >= sleepMsec && Stopped())
+        next = Mode_Sleep;
+    else if (idle >= idleMsec)
+        next = Mode_Idle;
+    if (next == mode)
+        return;
+    if (settings[next].mhz != settings[mode].mhz)
+        setCpuFrequencyMhz(settings[next].mhz);
+    mode = next;
+    flogi("Power %s", settings[mode].name);
+}
+
+uint16_t Wait(TickType_t& wake)
+{
+    unsigned long msec = millis();
+    if (timeWaitLast != 0)
+        modeMsec[mode] += msec - timeWaitLast;
+    timeWaitLast = msec;
+    Step(msec);
+
+    const Setting& s = settings[mode];
+    if (mode == Mode_Sleep && resting)
+    {
+        // both cores stop until the timer or the touchscreen, the radio is off meanwhile
+        esp_sleep_enable_timer_wakeup(s.period * 1000ULL);
+        // the wakeup needs a level on the active low line, which would refire the Touch interrupt
+        // while held, so it only has the pin while asleep and the falling edge is restored after
+        gpio_wakeup_enable((gpio_num_t)STMPE_IRQ, GPIO_INTR_LOW_LEVEL);
+        esp_light_sleep_start();
+        gpio_wakeup_disable((gpio_num_t)STMPE_IRQ);
+        gpio_set_intr_type((gpio_num_t)STMPE_IRQ, GPIO_INTR_NEGEDGE);
+        // the tick count stood still while the clock slept
+        wake = xTaskGetTickCount();
+    }
+    else
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(s.period));
+    return s.period;
+}
+
+void Ticked()
+{
+    if (uiTask != nullptr)
+        xTaskNotifyGive(uiTask);
+}
+
+void Rest()
+{
+    resting = true;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(settings[mode].rest));
+    resting = false;
+}
+
+void Report()
+{
+    uint32_t total = 0;
+    uint64_t charge = 0;
+    for (int m = 0; m < Mode_Count; m++)
+    {
+        total += modeMsec[m];
+        charge += (uint64_t)modeMsec[m] * settings[m].mA;
+        flogi("Power %-6s %6u s %3u mA", settings[m].name, modeMsec[m] / 1000, settings[m].mA);
+    }
+    if (total != 0)
+        flogi("Power average %u mA", (uint32_t)(charge / total));
+}
+
+};
@@ -0,0 +1,250 @@
+#include "Profiler.h"
+#include "Layout.h"
+#include "Trace.h"
+#include "Sync.h"
+#include "Scene.h"
+#include "Power.h"
+
+namespace Profiler
+{
+/**
+ * @brief Accumulated time for a section
+ */
+struct Accumulator
+{
+    uint32_t count;     // times entered
+    uint64_t nsec;      // total time spent
+    uint32_t max;       // most nsec spent in one pass
+};
+
+Accumulator accs[Section_Count];
+uint32_t tickNsec[Section_Count];   // time spent in each section since the last control tick, for tracing
+
+// upper bounds, in usec, of the loop period histogram bins, the last bin takes the rest
+const uint32_t binLimits[binCount - 1] = { 250, 500, 1000, 2000, 5000, 10000, 20000 };
+uint32_t bins[binCount];        // loop periods counted in each bin
+
+uint32_t loopUsecLast = 0;      // micros() at the start of the last loop()
+uint32_t tickUsecLast = 0;      // micros() at the start of the last control tick
+uint32_t jitterMax = 0;         // the largest control tick deviation, in usec
+unsigned long timeSnapLast = 0; // millis() of the last snapshot
+Power::Modes snapMode = Power::Mode_Active; // the power mode the accumulators were gathered in
+bool active = false;
+portMUX_TYPE accMux = portMUX_INITIALIZER_UNLOCKED;  // the accumulators are added to from both cores
+
+void Add(Sections section, uint32_t cycles)
+{
+    // converted now, as Power may change the clock before they are shown
+    uint32_t nsec = (uint64_t)cycles * 1000 / getCpuFrequencyMhz();
+    Accumulator& acc = accs[section];
+    portENTER_CRITICAL(&accMux);
+    acc.count++;
+    acc.nsec += nsec;
+    if (nsec > acc.max)
+        acc.max = nsec;
+    tickNsec[section] += nsec;
+    portEXIT_CRITICAL(&accMux);
+}
+
+void LoopStart()
+{
+    // the loop period may span a clock change, so it is timed in usec rather than cycles
+    uint32_t usec = micros();
+    if (loopUsecLast != 0)
+    {
+        uint32_t period = usec - loopUsecLast;
+        int bin = 0;
+        while (bin < binCount - 1 && period >= binLimits[bin])
+            bin++;
+        bins[bin]++;
+    }
+    loopUsecLast = usec;
+}
+
+void Tick(uint16_t period)
+{
+    uint32_t usec = micros();
+    if (tickUsecLast != 0)
+    {
+        int32_t jitter = (int32_t)(usec - tickUsecLast) - period * 1000L;
+        jitter = abs(jitter);
+        portENTER_CRITICAL(&accMux);
+        if ((uint32_t)jitter > jitterMax)
+            jitterMax = jitter;
+        portEXIT_CRITICAL(&accMux);
+    }
+    tickUsecLast = usec;
+    // the stages are traced once a tick, however often they ran, so they can't flood the link
+    uint32_t spent[Section_Count];
+    portENTER_CRITICAL(&accMux);
+    memcpy(spent, tickNsec, sizeof(spent));
+    memset(tickNsec, 0, sizeof(tickNsec));
+    portEXIT_CRITICAL(&accMux);
+    for (int i = 0; i < Section_Count; i++)
+    {
+        if (spent[i] != 0)
+            Trace::Stage((Sections)i, spent[i] / 1000);
+    }
+}
+
+using Layout::Widget;
+
+/**
+ * @brief Make a fixed text widget
+ */
+constexpr Widget Label(uint8_t col, uint8_t row, uint8_t cols, const char* text)
+{
+    return { Layout::Widget_Label, col, row, cols, 1, HX8357_WHITE, EntityID_None, PropertyID_None, 0, 0, text };
+}
+
+/**
+ * @brief Make a numeric text widget
+ */
+constexpr Widget Value(uint8_t col, uint8_t row, uint8_t cols)
+{
+    return { Layout::Widget_Text, col, row, cols, 1, HX8357_CYAN, EntityID_None, PropertyID_None, 0, 0, nullptr };
+}
+
+/**
+ * @brief The fixed text of the page
+ */
+constexpr Widget labels[] =
+{
+    Label( 1, 0, 7, "Stage"),   Label( 9, 0, 5, "avg"),     Label(15, 0, 5, "max"),     Label(21, 0, 4, "%CPU"),
+    Label( 1, 1, 7, "Touch"),
+    Label( 1, 2, 7, "Pad"),
+    Label( 1, 3, 7, "Sync"),
+    Label( 1, 4, 7, "History"),
+    Label( 1, 5, 7, "Changes"),
+    Label( 1, 6, 7, "Trace"),
+    Label( 1, 7, 7, "Loop"),
+    Label( 1, 8, 7, "Jitter"),  Label(15, 8, 5, "Loops"),
+    Label(28, 0, 6, "Period"),
+    Label(28, 1, 5, "<250u"),
+    Label(28, 2, 5, "<500u"),
+    Label(28, 3, 5, "<1m"),
+    Label(28, 4, 5, "<2m"),
+    Label(28, 5, 5, "<5m"),
+    Label(28, 6, 5, "<10m"),
+    Label(28, 7, 5, "<20m"),
+    Label(28, 8, 5, ">20m"),
+};
+
+const int labelCount = sizeof(labels) / sizeof(Widget);
+
+// slots of the value widgets, after the 3 for each Section
+const int valueJitter = Section_Count * 3;
+const int valueLoops = valueJitter + 1;
+const int valueBins = valueLoops + 1;
+const int valueCount = valueBins + binCount;
+
+/**
+ * @brief The widgets showing the statistics and their screen rectangles
+ */
+struct ValueWidgets
+{
+    Widget widget[valueCount];
+    Layout::Rect rect[valueCount];
+};
+
+constexpr ValueWidgets BuildValues()
+{
+    ValueWidgets values {};
+    for (int i = 0; i < Section_Count; i++)
+    {
+        values.widget[i * 3] = Value(9, i + 1, 5);      // average usec
+        values.widget[i * 3 + 1] = Value(15, i + 1, 5); // maximum usec
+        values.widget[i * 3 + 2] = Value(21, i + 1, 4); // percent of the CPU
+    }
+    values.widget[valueJitter] = Value(9, 8, 5);
+    values.widget[valueLoops] = Value(21, 8, 6);
+    for (int i = 0; i < binCount; i++)
+        values.widget[valueBins + i] = { Layout::Widget_Bar, 33, (uint8_t)(i + 1), 6, 1, HX8357_GREEN, EntityID_None, PropertyID_None, 0, 100, nullptr };
+    for (int i = 0; i < valueCount; i++)
+        values.rect[i] = Layout::Place(values.widget[i]);
+    return values;
+}
+
+constexpr ValueWidgets values = BuildValues();
+
+Layout::WidgetState labelStates[labelCount];
+Layout::WidgetState valueStates[valueCount];
+int16_t snapshot[valueCount];   // the values last computed
+
+/**
+ * @brief Saturate a value for display
+ */
+inline int16_t Clip(uint64_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (int16_t)v;
+}
+
+/**
+ * @brief Compute the snapshot values from the accumulators and restart them
+ *
+ * @param usec The elapsed time covered by the accumulators
+ */
+void Snapshot(uint32_t usec)
+{
+    uint64_t window = (uint64_t)usec * 1000;
+    portENTER_CRITICAL(&accMux);
+    for (int i = 0; i < Section_Count; i++)
+    {
+        Accumulator& acc = accs[i];
+        snapshot[i * 3] = acc.count ? Clip(acc.nsec / acc.count / 1000) : 0;
+        snapshot[i * 3 + 1] = Clip(acc.max / 1000);
+        snapshot[i * 3 + 2] = window ? Clip(acc.nsec * 100 / window) : 0;
+        acc = { 0, 0, 0 };
+    }
+    snapshot[valueJitter] = Clip(jitterMax);
+    jitterMax = 0;
+    portEXIT_CRITICAL(&accMux);
+    uint32_t loops = 0;
+    for (int i = 0; i < binCount; i++)
+        loops += bins[i];
+    snapshot[valueLoops] = Clip(loops);
+    for (int i = 0; i < binCount; i++)
+    {
+        snapshot[valueBins + i] = loops ? bins[i] * 100 / loops : 0;
+        bins[i] = 0;
+    }
+}
+
+void Loop()
+{
+    unsigned long msec = millis();
+    // a power mode change closes the window early, so each snapshot is of a single mode
+    if (msec - timeSnapLast < 1000 && Power::Mode() == snapMode)
+        return;
+    Snapshot((msec - timeSnapLast) * 1000);
+    timeSnapLast = msec;
+    snapMode = Power::Mode();
+    if (!active)
+        return;
+    for (int i = 0; i < valueCount; i++)
+        Layout::Update(values.widget[i], values.rect[i], valueStates[i], snapshot[i]);
+}
+
+void Activate()
+{
+    active = true;
+    // no robot telemetry is shown
+    Sync::Subscribe(nullptr, 0);
+    Scene::Begin(HX8357_BLACK);
+    for (int i = 0; i < labelCount; i++)
+        Layout::Present(labels[i], Layout::Place(labels[i]), labelStates[i], 0);
+    for (int i = 0; i < valueCount; i++)
+        Layout::Present(values.widget[i], values.rect[i], valueStates[i], snapshot[i]);
+    Scene::End();
+    for (int i = 0; i < labelCount; i++)
+        Layout::Show(labels[i], Layout::Place(labels[i]), labelStates[i], 0);
+    for (int i = 0; i < valueCount; i++)
+        Layout::Show(values.widget[i], values.rect[i], valueStates[i], snapshot[i]);
+}
+
+void Deactivate()
+{
+    active = false;
+}
+
+};
@@ -0,0 +1,219 @@
+#include "Profiles.h"
+#include "Controller.h"
+#include "Pad.h"
+#include "FLogger.h"
+#include <atomic>
+#ifdef ARDUINO
+#include <Preferences.h>
+#else
+#include <stdio.h>
+#endif
+
+namespace Profiles
+{
+/**
+ * @brief The built-in profiles
+ */
+const Profile defaults[] =
+{
+    {
+        "Normal",
+        { 0.0f, 1.0f, 0.5f },
+        4.031f, 0.027f, (0.027f * 100.0f) / 255.0f,
+        //
+        // from "Motion Planning for Omnidirectional Wheeled Mobile Robot by Potential Field Method" equation (7)
+        // as computed by the custom program 'OmniCtrl'
+        // the matrix 'M', from columns A1, A2, and A3
+        //
+        {
+            { -0.0110f, -0.0235f, 2.7273f },
+            { -0.0110f,  0.0235f, 2.7273f },
+            {  0.0260f,  0.0000f, 3.7662f },
+        },
+        27,
+        { -100, -100, -100, -255 },
+        {  100,  100,  100,  255 },
+    },
+    {
+        // slower, with a wider deadzone, for close quarters and new drivers
+        "Gentle",
+        { 0.0f, 0.5f, 0.25f },
+        4.031f, 0.020f, (0.020f * 100.0f) / 255.0f,
+        {
+            { -0.0110f, -0.0235f, 2.7273f },
+            { -0.0110f,  0.0235f, 2.7273f },
+            {  0.0260f,  0.0000f, 3.7662f },
+        },
+        40,
+        { -50, -50, -50, -255 },
+        {  50,  50,  50,  255 },
+    },
+};
+
+/**
+ * @brief The profiles as stored, only the profiles in use are written
+ */
+struct Stored
+{
+    uint8_t version;
+    uint8_t count;
+    uint8_t active;
+    uint8_t reserved;
+    Profile profiles[profileMax];
+};
+
+Stored stored;
+std::atomic<bool> selected(false);  // the selection changed since it was stored, set by the control task
+std::atomic<unsigned long> timeSelected(0); // millis() of the last selection
+
+const size_t headerSize = offsetof(Stored, profiles);
+
+/**
+ * @brief Get the bytes to store for the profiles in use
+ */
+inline size_t StoredSize()
+{
+    return headerSize + stored.count * sizeof(Profile);
+}
+
+#ifdef ARDUINO
+const char* nvsNamespace = "profiles";
+const char* nvsKey = "set";
+
+/**
+ * @brief Read the stored profiles from NVS
+ */
+bool Read()
+{
+    Preferences prefs;
+    if (!prefs.begin(nvsNamespace, true))
+        return false;
+    size_t len = prefs.getBytes(nvsKey, &stored, sizeof(stored));
+    prefs.end();
+    return len >= headerSize && len == StoredSize();
+}
+
+/**
+ * @brief Write the stored profiles to NVS
+ */
+bool Write()
+{
+    Preferences prefs;
+    if (!prefs.begin(nvsNamespace, false))
+        return false;
+    size_t len = prefs.putBytes(nvsKey, &stored, StoredSize());
+    prefs.end();
+    return len == StoredSize();
+}
+#else
+const char* fileName = "profiles.bin";
+
+/**
+ * @brief Read the stored profiles from the stand-in file
+ */
+bool Read()
+{
+    FILE* f = fopen(fileName, "rb");
+    if (f == nullptr)
+        return false;
+    size_t len = fread(&stored, 1, sizeof(stored), f);
+    fclose(f);
+    return len >= headerSize && len == StoredSize();
+}
+
+/**
+ * @brief Write the stored profiles to the stand-in file
+ */
+bool Write()
+{
+    FILE* f = fopen(fileName, "wb");
+    if (f == nullptr)
+        return false;
+    size_t len = fwrite(&stored, 1, StoredSize(), f);
+    fclose(f);
+    return len == StoredSize();
+}
+#endif
+
+/**
+ * @brief Have the Controller and Pad precompute from the active profile
+ */
+void Apply()
+{
+    const Profile& profile = stored.profiles[stored.active];
+    Controller::SetProfile(profile);
+    Pad::SetProfile(profile);
+    flogi("profile %s", profile.name);
+}
+
+void Reset()
+{
+    memset(&stored, 0, sizeof(stored));
+    stored.version = version;
+    stored.count = sizeof(defaults) / sizeof(Profile);
+    memcpy(stored.profiles, defaults, sizeof(defaults));
+    if (!Write())
+        floge("profiles not stored");
+    Apply();
+}
+
+void Init()
+{
+    if (!Read() || stored.version != version || stored.count == 0 || stored.count > profileMax || stored.active >= stored.count)
+    {
+        flogi("default profiles");
+        Reset();
+        return;
+    }
+    Apply();
+}
+
+uint8_t Count()
+{
+    return stored.count;
+}
+
+const Profile& Get(uint8_t index)
+{
+    return stored.profiles[index < stored.count ? index : stored.active];
+}
+
+uint8_t Active()
+{
+    return stored.active;
+}
+
+void Select(uint8_t index)
+{
+    if (index >= stored.count || index == stored.active)
+        return;
+    stored.active = index;
+    Apply();
+    timeSelected = millis();
+    selected = true;
+}
+
+void Save()
+{
+    if (!selected || millis() - timeSelected < saveDelay)
+        return;
+    selected = false;
+    // only the header changes, but NVS writes the blob whole either way
+    if (!Write())
+        floge("profiles not stored");
+}
+
+bool Store(uint8_t index, const Profile& profile)
+{
+    if (index > stored.count || index >= profileMax)
+        return false;
+    stored.profiles[index] = profile;
+    stored.profiles[index].name[profileNameMax] = '\0';
+    if (index == stored.count)
+        stored.count++;
+    if (index == stored.active)
+        Apply();
+    return Write();
+}
+
+};
@@ -0,0 +1,160 @@
+#include "PsxSpi.h"
+#include "FLogger.h"
+#include <driver/gpio.h>
+
+PsxControllerSpi::PsxControllerSpi(spi_host_device_t host, int8_t att, int8_t cmd, int8_t dat, int8_t clk, int8_t ack)
+    : host(host), att(att), cmd(cmd), dat(dat), clk(clk), ack(ack)
+{
+}
+
+boolean PsxControllerSpi::begin()
+{
+    // Pad retries begin while the controller is missing, the bus only needs setting up once
+    if (device == nullptr)
+    {
+        pinMode(att, OUTPUT);
+        digitalWrite(att, HIGH);
+        if (ack >= 0)
+            pinMode(ack, INPUT_PULLUP);
+
+        spi_bus_config_t bus = {};
+        bus.mosi_io_num = cmd;
+        bus.miso_io_num = dat;
+        bus.sclk_io_num = clk;
+        bus.quadwp_io_num = -1;
+        bus.quadhd_io_num = -1;
+        bus.max_transfer_sz = sizeof(frameIn);
+        if (spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) != ESP_OK)
+        {
+            floge("PSX SPI bus init failed");
+            return false;
+        }
+
+        spi_device_interface_config_t dev = {};
+        dev.mode = 3;
+        dev.clock_speed_hz = clockHz;
+        dev.spics_io_num = -1;      // attention is driven around whole packets
+        dev.queue_size = 1;
+        dev.flags = SPI_DEVICE_BIT_LSBFIRST;
+        dev.post_cb = &FrameDone;
+        if (spi_bus_add_device(host, &dev, &device) != ESP_OK)
+        {
+            floge("PSX SPI device init failed");
+            device = nullptr;
+            return false;
+        }
+
+        // the poll never changes, the bytes past the command are what the base class sends
+        memset(frameOut, 0x5A, sizeof(frameOut));
+        memcpy(frameOut, poll, sizeof(poll));
+        frame.length = frameSize * 8;
+        frame.tx_buffer = frameOut;
+        frame.rx_buffer = frameIn;
+        frame.user = this;
+    }
+    return PsxController::begin();
+}
+
+void IRAM_ATTR PsxControllerSpi::FrameDone(spi_transaction_t* t)
+{
+    // the byte at a time exchanges keep attention for the rest of their packet
+    if (t->user != nullptr)
+        gpio_set_level((gpio_num_t)((PsxControllerSpi*)t->user)->att, 1);
+}
+
+bool PsxControllerSpi::StartRead()
+{
+    if (device == nullptr || framing)
+        return false;
+    attention();
+    if (spi_device_queue_trans(device, &frame, 0) != ESP_OK)
+    {
+        noAttention();
+        return false;
+    }
+    framing = true;
+    return true;
+}
+
+bool PsxControllerSpi::FinishRead()
+{
+    if (!framing)
+        return false;
+    spi_transaction_t* t;
+    if (spi_device_get_trans_result(device, &t, portMAX_DELAY) != ESP_OK)
+        return false;
+    framing = false;
+    // the base class reads the frame already in, taking its bytes from it rather than the bus
+    replay = frameIn;
+    replayed = 0;
+    bool ok = read();
+    replay = nullptr;
+    return ok;
+}
+
+void PsxControllerSpi::attention()
+{
+    if (replay != nullptr)
+        return;
+    digitalWrite(att, LOW);
+    delayMicroseconds(attentionUsec);
+}
+
+void PsxControllerSpi::noAttention()
+{
+    if (replay != nullptr)
+        return;
+    digitalWrite(att, HIGH);
+    delayMicroseconds(attentionUsec);
+}
+
+bool PsxControllerSpi::WaitAck()
+{
+    uint32_t start = micros();
+    // the pulse is low for a few usec, then the pad is ready for the next byte
+    while (digitalRead(ack) != LOW)
+    {
+        if (micros() - start > ackTimeoutUsec)
+            return false;
+    }
+    while (digitalRead(ack) == LOW)
+    {
+        if (micros() - start > ackTimeoutUsec)
+            return false;
+    }
+    return true;
+}
+
+void PsxControllerSpi::shiftInOut(const byte* out, byte* in, const byte len)
+{
+    if (replay == nullptr)
+    {
+        PsxController::shiftInOut(out, in, len);
+        return;
+    }
+    // a frame already in has no gaps to wait out, and no more than it holds
+    for (byte i = 0; i < len; i++)
+    {
+        byte b = replayed < frameSize ? replay[replayed++] : 0xFF;
+        if (in != nullptr)
+            in[i] = b;
+    }
+}
+
+byte PsxControllerSpi::shiftInOut(const byte out)
+{
+    if (replay != nullptr)
+        return replayed < frameSize ? replay[replayed++] : 0xFF;
+    // no bus, no controller: the data line floats high
+    if (device == nullptr)
+        return 0xFF;
+    spi_transaction_t t = {};
+    t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    t.length = 8;
+    t.tx_data[0] = out;
+    // a single byte is over before an interrupt could be taken
+    spi_device_polling_transmit(device, &t);
+    if (ack >= 0)
+        WaitAck();
+    return t.rx_data[0];
+}
@@ -0,0 +1,131 @@
+#include "Scene.h"
+
+namespace Scene
+{
+/**
+ * @brief A retained screen rectangle and its content
+ */
+struct Node
+{
+    Layout::Rect rect;
+    uint32_t key;
+};
+
+Node shown[nodeMax];        // the nodes on the screen
+uint8_t shownCount = 0;
+Node placed[nodeMax];       // the nodes of the page being presented
+uint8_t placedCount = 0;
+bool dirty[nodeMax];        // the placed nodes needing drawing
+bool retained[nodeMax];     // the shown nodes placed again
+
+uint16_t background = 0;    // the page background color on the screen
+bool known = false;         // the screen holds a presented page
+uint16_t newBackground = 0;
+uint32_t uniqueLast = 0;
+
+/**
+ * @brief Determine if two rectangles are identical
+ */
+inline bool Same(const Layout::Rect& a, const Layout::Rect& b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+/**
+ * @brief Determine if two rectangles overlap
+ */
+inline bool Overlap(const Layout::Rect& a, const Layout::Rect& b)
+{
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void Begin(uint16_t color)
+{
+    newBackground = color;
+    placedCount = 0;
+    memset(retained, 0, sizeof(retained));
+}
+
+int Place(const Layout::Rect& r, uint32_t key)
+{
+    if (placedCount >= nodeMax)
+        return -1;
+    int node = placedCount++;
+    placed[node] = { r, key };
+    dirty[node] = true;
+    if (!known || newBackground != background)
+        return node;
+    for (int i = 0; i < shownCount; i++)
+    {
+        if (!retained[i] && shown[i].key == key && Same(shown[i].rect, r))
+        {
+            retained[i] = true;
+            dirty[node] = false;
+            break;
+        }
+    }
+    return node;
+}
+
+void End()
+{
+    if (!known || newBackground != background)
+    {
+        tft.fillRect(pageRect.x, pageRect.y, pageRect.w, pageRect.h, newBackground);
+    }
+    else
+    {
+        // clear the damage rectangles, any kept node they touch must be drawn again
+        for (int i = 0; i < shownCount; i++)
+        {
+            if (retained[i])
+                continue;
+            const Layout::Rect& r = shown[i].rect;
+            tft.fillRect(r.x, r.y, r.w, r.h, background);
+            for (int j = 0; j < placedCount; j++)
+            {
+                if (!dirty[j] && Overlap(placed[j].rect, r))
+                    dirty[j] = true;
+            }
+        }
+    }
+    background = newBackground;
+    known = true;
+    memcpy(shown, placed, sizeof(Node) * placedCount);
+    shownCount = placedCount;
+}
+
+bool Dirty(int node)
+{
+    return node < 0 || dirty[node];
+}
+
+void Rekey(int node, uint32_t key)
+{
+    if (node >= 0 && node < shownCount)
+        shown[node].key = key;
+}
+
+uint32_t Unique()
+{
+    // keys from Hash are very unlikely to be this small
+    return ++uniqueLast;
+}
+
+void Opaque(uint16_t color)
+{
+    Begin(color);
+    Place(pageRect, Unique());
+    End();
+}
+
+uint32_t Hash(uint32_t key, const void* data, size_t len)
+{
+    // FNV-1a
+    const uint8_t* p = (const uint8_t*)data;
+    while (len-- > 0)
+        key = (key ^ *p++) * 16777619u;
+    return key;
+}
+
+};
@@ -0,0 +1,263 @@
+#include "SimPeer.h"
+#include "Sync.h"
+#include "State.h"
+#include "FLogger.h"
+
+namespace SimPeer
+{
+/**
+ * @brief A frame on its way, one way or the other
+ */
+struct Flight
+{
+    bool used;
+    bool up;                // to the peer, otherwise back to us
+    uint32_t sent;          // micros() sent
+    uint32_t due;           // micros() it arrives
+    uint8_t len;
+    uint8_t data[Sync::frameMax];
+};
+
+const uint8_t flightMax = 8;    // frames on their way at once
+
+/**
+ * @brief A Property the controller has subscribed to, and what was last sent of it
+ */
+struct Wanted
+{
+    EntityID entity;
+    PropertyID property;
+    uint8_t rate;           // maximum updates per second, 0 for unlimited
+    bool sent;              // a value has been sent
+    int16_t value;          // the value last sent
+    unsigned long last;     // millis() it was sent
+};
+
+const uint8_t wantedMax = 24;   // the most Subscriptions, as many as Sync sends
+
+Flight flights[flightMax];
+uint32_t start = 0;             // micros() the peer's drift counts from
+int32_t offset = offsetUsec;    // usec the peer's clock was ahead at the start
+int32_t drift = driftPpb;       // parts per billion the peer's clock runs fast
+int16_t goals[entityCount];     // the motor goals received
+Wanted wanted[wantedMax];       // the Properties subscribed to
+uint8_t wantedCount = 0;        // the number of Properties subscribed to
+uint16_t sequence = 0;          // sequence number of the next telemetry frame
+unsigned long timeTelemetryLast = 0;    // millis() of the last telemetry frame
+uint32_t framesSent = 0;        // frames sent back to us
+uint32_t up = 0;                // the true delays, averaged
+uint32_t down = 0;
+bool haveUp = false;
+bool haveDown = false;
+
+/**
+ * @brief The peer's micros() at one of ours
+ */
+uint32_t PeerClock(uint32_t usec)
+{
+    return usec + offset + (int32_t)((int64_t)(int32_t)(usec - start) * drift / 1000000000LL);
+}
+
+void SetDrift(int32_t ppb)
+{
+    uint32_t usec = micros();
+    offset = PeerClock(usec) - usec;
+    start = usec;
+    drift = ppb;
+}
+
+/**
+ * @brief Put a frame on its way
+ *
+ * @param up true to the peer, false back to us
+ * @param sent micros() it is sent
+ */
+void Fly(const uint8_t* data, int len, bool up, uint32_t sent)
+{
+    if (len > Sync::frameMax)
+        return;
+    for (Flight& f : flights)
+    {
+        if (f.used)
+            continue;
+        f.used = true;
+        f.up = up;
+        f.sent = sent;
+        f.due = sent + delayUsec + random(jitterUsec + 1);
+        f.len = len;
+        memcpy(f.data, data, len);
+        if (!up)
+            framesSent++;
+        return;
+    }
+    // a full link loses the frame, as the radio would
+}
+
+void Receive(const uint8_t* data, int len)
+{
+    if (start == 0)
+        start = micros();
+    Fly(data, len, true, micros());
+}
+
+/**
+ * @brief Process a frame arriving at the peer
+ *
+ * @param f The frame
+ */
+void Arrive(const Flight& f)
+{
+    const uint8_t* p = f.data;
+    const uint8_t* end = f.data + f.len;
+    if (f.len < 3 || *p++ != Sync::frameMagic)
+        return;
+    uint8_t flags = *p++;
+    uint16_t seq;
+    if (!Sync::GetVarint(p, end, seq))
+        return;
+    if (flags & Sync::FrameFlags_Time)
+    {
+        // answer with our times, leaving the request's own
+        uint32_t t1;
+        if (!Sync::GetFixed(p, end, t1, 4))
+            return;
+        uint8_t buf[Sync::frameMax];
+        uint8_t* q = buf;
+        *q++ = Sync::frameMagic;
+        *q++ = Sync::FrameFlags_Time;
+        Sync::PutVarint(q, 0);
+        Sync::PutFixed(q, t1, 4);
+        Sync::PutFixed(q, PeerClock(f.due), 4);
+        Sync::PutFixed(q, PeerClock(f.due + turnaroundUsec), 4);
+        Fly(buf, q - buf, false, f.due + turnaroundUsec);
+        return;
+    }
+    // the records, past the stamp
+    if (flags & Sync::FrameFlags_Stamped)
+        p += 2;
+    if (flags & Sync::FrameFlags_Subscribe)
+    {
+        // a new list replaces the old, all its values are sent afresh
+        wantedCount = 0;
+        while (p < end && wantedCount < wantedMax)
+        {
+            uint16_t entity, property, rate;
+            if (!Sync::GetVarint(p, end, entity) || !Sync::GetVarint(p, end, property) || !Sync::GetVarint(p, end, rate))
+                return;
+            wanted[wantedCount++] = { (EntityID)entity, (PropertyID)property, (uint8_t)Sync::UnZigZag(rate), false, 0, 0 };
+        }
+        return;
+    }
+    // keeping the motor goals
+    while (p < end)
+    {
+        uint16_t entity, property, v;
+        if (!Sync::GetVarint(p, end, entity) || !Sync::GetVarint(p, end, property) || !Sync::GetVarint(p, end, v))
+            return;
+        if (property == PropertyID_Goal && entity < entityCount)
+            goals[entity] = Sync::UnZigZag(v);
+    }
+}
+
+/**
+ * @brief The peer's value of a Property
+ */
+int16_t Measure(EntityID entity, PropertyID property)
+{
+    // the motors reach their goals at once
+    if ((property == PropertyID_Goal || property == PropertyID_RPM) && entity <= EntityID_RearMotor)
+        return goals[entity];
+    return 0;
+}
+
+/**
+ * @brief Send the subscribed values that have changed, all of them in a keyframe
+ */
+void SendTelemetry(uint32_t usec, unsigned long msec)
+{
+    bool keyframe = (sequence % keyframeInterval) == 0;
+    uint8_t buf[Sync::frameMax];
+    uint8_t* p = buf;
+    *p++ = Sync::frameMagic;
+    *p++ = Sync::FrameFlags_Stamped | (keyframe ? Sync::FrameFlags_Keyframe : 0);
+    Sync::PutVarint(p, sequence);
+    Sync::PutFixed(p, Sync::Stamp(PeerClock(usec)), 2);
+    uint8_t* records = p;
+    for (int i = 0; i < wantedCount && p + 9 <= buf + Sync::frameMax; i++)
+    {
+        Wanted& w = wanted[i];
+        int16_t v = Measure(w.entity, w.property);
+        if (!keyframe && w.sent && (v == w.value || (w.rate != 0 && msec - w.last < 1000UL / w.rate)))
+            continue;
+        Sync::PutVarint(p, w.entity);
+        Sync::PutVarint(p, w.property);
+        Sync::PutVarint(p, Sync::ZigZag(v));
+        w = { w.entity, w.property, w.rate, true, v, msec };
+    }
+    if (p == records && !keyframe)
+        return;
+    sequence++;
+    Fly(buf, p - buf, false, usec);
+}
+
+void Loop()
+{
+    uint32_t usec = micros();
+    if (start == 0)
+        start = usec;
+    unsigned long msec = millis();
+    if (msec - timeTelemetryLast >= telemetryMsec)
+    {
+        timeTelemetryLast = msec;
+        SendTelemetry(usec, msec);
+    }
+    // answers can arrive within the same tick, so keep on until nothing more is due
+    bool arrived = true;
+    while (arrived)
+    {
+        arrived = false;
+        for (Flight& f : flights)
+        {
+            if (!f.used || (int32_t)(usec - f.due) < 0)
+                continue;
+            // the slot is free for the answer
+            Flight arrival = f;
+            f.used = false;
+            arrived = true;
+            int32_t delay = arrival.due - arrival.sent;
+            if (arrival.up)
+            {
+                up = haveUp ? up + (delay - (int32_t)up) / 8 : delay;
+                haveUp = true;
+                Arrive(arrival);
+            }
+            else
+            {
+                down = haveDown ? down + (delay - (int32_t)down) / 8 : delay;
+                haveDown = true;
+                Sync::Post(arrival.data, arrival.len, arrival.due);
+            }
+        }
+    }
+}
+
+void Report()
+{
+    Truth t = GetTruth();
+    flogi("Sim clock %d us drift %d ppb", t.offset, t.drift);
+    flogi("Sim up %u us down %u us", t.up, t.down);
+    flogi("Sim %u frames sent %u subscribed", framesSent, wantedCount);
+}
+
+Truth GetTruth()
+{
+    uint32_t usec = micros();
+    return { (int32_t)(PeerClock(usec) - usec), drift, up, down };
+}
+
+uint32_t Frames()
+{
+    return framesSent;
+}
+
+};
@@ -0,0 +1,91 @@
+#include "State.h"
+#include <atomic>
+
+namespace State
+{
+/**
+ * @brief All the values of the control state
+ */
+struct Values
+{
+    int16_t v[entityCount][propertyCount];
+};
+
+Values working;                         // control task: the values as they change
+bool dirty = false;                     // control task: the working copy differs from the snapshot
+
+Values snapshot;                        // the published copy
+std::atomic<uint32_t> sequence(0);      // odd while the snapshot is being written
+
+Values view;                            // UI: the copy last read
+uint32_t viewSequence = 0;              // UI: the sequence of the copy last read
+Values seen;                            // UI: the values last reported by Diff
+
+/**
+ * @brief Determine if IDs are in range
+ */
+inline bool Valid(EntityID entity, PropertyID property)
+{
+    return entity < entityCount && property < propertyCount;
+}
+
+void Set(EntityID entity, PropertyID property, int16_t v)
+{
+    if (!Valid(entity, property) || working.v[entity][property] == v)
+        return;
+    working.v[entity][property] = v;
+    dirty = true;
+}
+
+void Publish()
+{
+    if (!dirty)
+        return;
+    dirty = false;
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshot = working;
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool Read()
+{
+    for (;;)
+    {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before == viewSequence)
+            return false;
+        if (before & 1)
+            continue;   // being written, the writer finishes in microseconds
+        Values copy = snapshot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before)
+            continue;   // torn, try again
+        view = copy;
+        viewSequence = before;
+        return true;
+    }
+}
+
+int16_t Get(EntityID entity, PropertyID property)
+{
+    return Valid(entity, property) ? view.v[entity][property] : 0;
+}
+
+void Diff(change_cb func)
+{
+    for (int e = 0; e < entityCount; e++)
+    {
+        for (int p = 0; p < propertyCount; p++)
+        {
+            int16_t v = view.v[e][p];
+            if (v == seen.v[e][p])
+                continue;
+            seen.v[e][p] = v;
+            (*func)((EntityID)e, (PropertyID)p, v);
+        }
+    }
+}
+
+};
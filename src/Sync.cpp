@@ -0,0 +1,782 @@
+#include "Sync.h"
+#include <esp_now.h>
+#include "FLogger.h"
+#include "PSXPad.h"
+#include "State.h"
+#include "SimPeer.h"
+#include <atomic>
+
+namespace Sync
+{
+/**
+ * @brief The last known value of a synchronized Property
+ */
+struct Slot
+{
+    EntityID entity;
+    PropertyID property;
+    int16_t value;
+    bool dirty;     // changed since last sent
+};
+
+const uint8_t slotMax = 16;     // more than enough for all the Properties we control
+
+Slot slots[slotMax];            // the synchronized Properties, allocated on first Set
+uint8_t slotCount = 0;          // the number of slots in use
+
+const uint8_t* peerAddress = nullptr;   // MAC address of the robot
+bool offered = false;           // clock exchanges are sent to find out if the robot takes Sync frames
+bool frames = false;            // Sync frames are exchanged rather than the Domain's messages
+unsigned long timeAnswerLast = 0;   // millis() of the last clock exchange answered
+uint16_t sequence = 0;          // sequence number of the next frame sent
+uint16_t sequenceRx = 0;        // sequence number expected for the next frame received
+bool haveRx = false;            // a frame has been received, sequenceRx is valid
+Stats stats;
+
+const uint8_t subMax = 24;      // the most Subscriptions a UI page may have
+
+const Subscription* subs = nullptr; // the Subscriptions of the active UI page
+uint8_t subCount = 0;           // the number of Subscriptions
+std::atomic<bool> subSent(true);    // the Subscriptions have been sent to the robot, cleared by the UI
+portMUX_TYPE subMux = portMUX_INITIALIZER_UNLOCKED; // subs and subCount are replaced by the UI while the control task sends them
+
+/**
+ * @brief Delivery state for each Subscription
+ */
+struct SubState
+{
+    unsigned long last;     // millis() of the last delivery
+    bool held;              // a change is held back to deliver
+};
+
+SubState subStates[subMax];
+
+const uint8_t filterMax = 16;   // the most filters
+
+const TelemetryFilter* filters = nullptr;   // the filters for changes received
+uint8_t filterCount = 0;        // the number of filters
+
+/**
+ * @brief Filtering state for each filter
+ */
+struct FilterState
+{
+    bool valid;             // a value has been passed
+    bool held;              // a change is held back until the interval elapses
+    int16_t value;          // the value last passed
+    int16_t pending;        // the change held back
+    unsigned long last;     // millis() the value was passed
+};
+
+FilterState filterStates[filterMax];
+
+/**
+ * @brief A clock exchange, for choosing the offset
+ */
+struct Exchange
+{
+    uint32_t usec;          // micros() the answer arrived
+    int32_t offset;         // the offset it measured
+    uint32_t roundTrip;     // its round trip, less the robot's turnaround
+};
+
+const uint32_t driftUsec = 10000000;    // the least time the offsets measuring the drift span
+const uint8_t trendMax = 32;            // the window minimums the drift is fitted to, 4 minutes of them
+
+Clock estimate;                 // the clock and latency estimates
+Exchange exchanges[clockWindow];    // the recent exchanges
+uint8_t exchangeCount = 0;      // the exchanges in the window
+uint8_t exchangeNext = 0;       // where the next exchange goes
+Exchange best;                  // the exchange the offset is from
+Exchange trend[trendMax];       // the fastest exchange of each full window
+uint8_t trendCount = 0;         // the windows in the trend
+uint8_t trendNext = 0;          // where the next window goes
+bool haveAge = false;           // the age of values has been measured
+unsigned long timeExchangeLast = 0; // millis() of the last clock exchange sent
+unsigned long timeKeyframeLast = 0; // millis() of the last keyframe sent
+
+/**
+ * @brief A frame received from the robot, waiting for Poll
+ */
+struct Received
+{
+    uint32_t usec;          // micros() it arrived
+    uint8_t len;
+    uint8_t data[frameMax];
+};
+
+const uint8_t receivedMax = 4;      // the most frames waiting
+QueueHandle_t received = nullptr;   // the frames waiting
+
+void Init(const uint8_t* peer)
+{
+    peerAddress = peer;
+    received = xQueueCreate(receivedMax, sizeof(Received));
+}
+
+/**
+ * @brief Queue every known value to be sent again, over a link that may not have had them
+ */
+void Resend()
+{
+    for (int i = 0; i < slotCount; i++)
+        slots[i].dirty = true;
+    subSent = false;
+}
+
+/**
+ * @brief Go back to the Domain's messages, with the robot not answering the frames
+ */
+void Fallback()
+{
+    if (!frames)
+        return;
+    frames = false;
+    Resend();
+    flogi("Sync Domain messages");
+}
+
+/**
+ * @brief Take up the frames once the robot has answered one
+ */
+void Answered()
+{
+    timeAnswerLast = millis();
+    if (frames || !offered)
+        return;
+    frames = true;
+    Resend();
+    flogi("Sync frames");
+}
+
+/**
+ * @brief The owner of each Property, in PropertyID order
+ */
+const Owners owners[] =
+{
+    Owner_Controller,   // None
+    Owner_Controller,   // Goal
+    Owner_Robot,        // RPM
+    Owner_Robot,        // Power
+    Owner_Robot,        // Position
+    Owner_Controller,   // Animation
+    Owner_Controller,   // ControlMode
+};
+
+const uint8_t ownerCount = sizeof(owners) / sizeof(Owners);
+
+const Stats& GetStats()
+{
+    return stats;
+}
+
+void Report()
+{
+    flogi("Sync %u sets %u sent %u echoes %u refused", stats.sets, stats.updates, stats.echoes, stats.refused);
+    flogi("Sync %u accepted %u filtered %u deferred", stats.accepted, stats.filtered, stats.deferred);
+    if (estimate.valid)
+    {
+        flogi("Sync clock %d us drift %d ppb rtt %u us", estimate.offset, estimate.drift, estimate.roundTrip);
+        flogi("Sync up %u us down %u us age %u ms max %u", estimate.up, estimate.down, estimate.age, estimate.ageMax);
+    }
+#ifdef SYNC_SIM
+    SimPeer::Report();
+#endif
+}
+
+const Clock& GetClock()
+{
+    return estimate;
+}
+
+Owners Owner(PropertyID property)
+{
+    // Properties unknown here can only have come from the robot
+    return property < ownerCount ? owners[property] : Owner_Robot;
+}
+
+/**
+ * @brief Find the slot for a Property
+ *
+ * @return Slot* The slot, or nullptr if the Property was never set
+ */
+Slot* Find(EntityID entity, PropertyID property)
+{
+    for (int i = 0; i < slotCount; i++)
+    {
+        if (slots[i].entity == entity && slots[i].property == property)
+            return &slots[i];
+    }
+    return nullptr;
+}
+
+void Set(EntityID entity, PropertyID property, int16_t v)
+{
+    if (Owner(property) != Owner_Controller)
+    {
+        stats.refused++;
+        return;
+    }
+    stats.sets++;
+    State::Set(entity, property, v);
+    Slot* slot = Find(entity, property);
+    if (slot != nullptr)
+    {
+        if (slot->value != v)
+        {
+            slot->value = v;
+            slot->dirty = true;
+        }
+        return;
+    }
+    if (slotCount >= slotMax)
+    {
+        floge("Sync slots exhausted");
+        return;
+    }
+    slots[slotCount++] = { entity, property, v, true };
+}
+
+int16_t Value(EntityID entity, PropertyID property)
+{
+    Slot* slot = Find(entity, property);
+    return slot != nullptr ? slot->value : 0;
+}
+
+void Filter(const TelemetryFilter* list, uint8_t count)
+{
+    if (count > filterMax)
+    {
+        floge("Too many filters");
+        count = filterMax;
+    }
+    filters = list;
+    filterCount = count;
+    for (int i = 0; i < filterCount; i++)
+        filterStates[i] = { false, false, 0, 0, 0 };
+}
+
+/**
+ * @brief Round a value to the nearest multiple of a quantum
+ */
+inline int16_t Quantize(int16_t v, uint8_t quantum)
+{
+    if (quantum <= 1)
+        return v;
+    int16_t half = quantum / 2;
+    return (v >= 0 ? v + half : v - half) / quantum * quantum;
+}
+
+bool Receive(EntityID entity, PropertyID property, int16_t& v)
+{
+    if (Owner(property) != Owner_Robot)
+    {
+        stats.echoes++;
+        return false;
+    }
+    for (int i = 0; i < filterCount; i++)
+    {
+        const TelemetryFilter& filter = filters[i];
+        if (filter.entity != entity || filter.property != property)
+            continue;
+        FilterState& state = filterStates[i];
+        v = Quantize(v, filter.quantum);
+        // coming to rest at zero is never hidden
+        if (state.valid && v != 0 && abs(v - state.value) <= filter.deadband)
+        {
+            // back within the deadband, so any change held back is moot
+            state.held = false;
+            stats.filtered++;
+            return false;
+        }
+        unsigned long msec = millis();
+        if (filter.interval != 0 && state.valid && msec - state.last < filter.interval)
+        {
+            // too soon, hold on to it for Settle
+            state.held = true;
+            state.pending = v;
+            stats.deferred++;
+            return false;
+        }
+        state = { true, false, v, 0, msec };
+        break;
+    }
+    stats.accepted++;
+    return true;
+}
+
+void Settle(sync_cb func)
+{
+    unsigned long msec = millis();
+    for (int i = 0; i < filterCount; i++)
+    {
+        FilterState& state = filterStates[i];
+        if (!state.held || msec - state.last < filters[i].interval)
+            continue;
+        state.held = false;
+        state.value = state.pending;
+        state.last = msec;
+        stats.accepted++;
+        (*func)(filters[i].entity, filters[i].property, state.value);
+    }
+}
+
+void PutVarint(uint8_t*& p, uint16_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+}
+
+bool GetVarint(const uint8_t*& p, const uint8_t* end, uint16_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 21 && p < end; shift += 7)
+    {
+        uint8_t b = *p++;
+        v |= (uint16_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+void PutFixed(uint8_t*& p, uint32_t v, uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++)
+    {
+        *p++ = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+bool GetFixed(const uint8_t*& p, const uint8_t* end, uint32_t& v, uint8_t size)
+{
+    if (end - p < size)
+        return false;
+    v = 0;
+    for (uint8_t i = 0; i < size; i++)
+        v |= (uint32_t)*p++ << (i * 8);
+    return true;
+}
+
+/**
+ * @brief Get the offset of the robot's clock at a time, the best offset carried forward by the drift
+ */
+int32_t Offset(uint32_t usec)
+{
+    return best.offset + (int32_t)((int64_t)(int32_t)(usec - best.usec) * estimate.drift / 1000000000LL);
+}
+
+/**
+ * @brief Fold a measurement into a running average
+ */
+inline void Average(uint32_t& avg, int32_t v, bool first)
+{
+    v = max(v, (int32_t)0);
+    avg = first ? v : (uint32_t)((int32_t)avg + (v - (int32_t)avg) / 8);
+}
+
+/**
+ * @brief Fit the drift to the offsets of the window minimums, by least squares
+ * @remarks Each offset is off by half the difference of its legs, hundreds of usec, so the drift
+ *      between any two is off by tens of ppm, where the slope through them all is off by a few.
+ */
+void FitDrift()
+{
+    const Exchange& oldest = trend[(trendNext + trendMax - trendCount) % trendMax];
+    const Exchange& newest = trend[(trendNext + trendMax - 1) % trendMax];
+    if (trendCount < 2 || newest.usec - oldest.usec < driftUsec)
+        return;
+    // from the oldest, to keep the precision, once per window so the doubles are no burden
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < trendCount; i++)
+    {
+        double x = (int32_t)(trend[i].usec - oldest.usec);
+        double y = trend[i].offset - oldest.offset;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double d = trendCount * sxx - sx * sx;
+    if (d > 0)
+        estimate.drift = (int32_t)lround((trendCount * sxy - sx * sy) / d * 1e9);
+}
+
+/**
+ * @brief Update the clock estimates from a completed exchange
+ *
+ * @param t1 micros() here when the request was sent
+ * @param t2 micros() on the robot when the request arrived
+ * @param t3 micros() on the robot when the answer was sent
+ * @param t4 micros() here when the answer arrived
+ */
+void Exchanged(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4)
+{
+    Exchange e = { t4, ((int32_t)(t2 - t1) + (int32_t)(t3 - t4)) / 2, (t4 - t1) - (t3 - t2) };
+    exchanges[exchangeNext] = e;
+    exchangeNext = (exchangeNext + 1) % clockWindow;
+    if (exchangeCount < clockWindow)
+        exchangeCount++;
+    // the fastest exchange waited least in the queues, so its two legs are the most alike
+    Exchange b = exchanges[0];
+    for (int i = 1; i < exchangeCount; i++)
+    {
+        if (exchanges[i].roundTrip < b.roundTrip)
+            b = exchanges[i];
+    }
+    if (exchangeNext == 0)
+    {
+        // a full window of exchanges since the last, its fastest joins the trend
+        trend[trendNext] = b;
+        trendNext = (trendNext + 1) % trendMax;
+        if (trendCount < trendMax)
+            trendCount++;
+        FitDrift();
+    }
+    bool first = !estimate.valid;
+    best = b;
+    estimate.roundTrip = b.roundTrip;
+    // each leg of this exchange, against the offset at the time
+    int32_t offset = Offset(t4);
+    estimate.offset = offset;
+    Average(estimate.up, (int32_t)(t2 - t1) - offset, first);
+    Average(estimate.down, (int32_t)(t4 - t3) + offset, first);
+    estimate.valid = true;
+    estimate.exchanges++;
+}
+
+/**
+ * @brief Measure the age of values from the robot by their frame stamp
+ */
+void Aged(uint16_t stamp)
+{
+    if (!estimate.valid)
+        return;
+    // the robot's clock now, compared with its clock when it sent them
+    uint32_t usec = micros();
+    int32_t age = max((int16_t)(Stamp(usec + Offset(usec)) - stamp), (int16_t)0);
+    Average(estimate.age, age, !haveAge);
+    haveAge = true;
+    if ((uint32_t)age > estimate.ageMax)
+        estimate.ageMax = age;
+}
+
+// the most bytes a single record can take: 3 varints of up to 3 bytes
+const uint8_t recordMax = 9;
+
+int Encode(uint8_t* buf, bool keyframe)
+{
+    uint8_t* p = buf;
+    *p++ = frameMagic;
+    *p++ = FrameFlags_Stamped | (keyframe ? FrameFlags_Keyframe : 0);
+    PutVarint(p, sequence);
+    PutFixed(p, Stamp(micros()), 2);
+    uint8_t* records = p;
+    for (int i = 0; i < slotCount; i++)
+    {
+        Slot& slot = slots[i];
+        if (!slot.dirty && !keyframe)
+            continue;
+        if (p + recordMax > buf + frameMax)
+            break;  // left dirty for the next frame
+        PutVarint(p, slot.entity);
+        PutVarint(p, slot.property);
+        PutVarint(p, ZigZag(slot.value));
+        slot.dirty = false;
+        stats.updates++;
+    }
+    if (p == records && !keyframe)
+        return 0;
+    sequence++;
+    return p - buf;
+}
+
+bool Decode(const uint8_t* data, int len, sync_cb func, sync_cb subFunc, uint32_t usec)
+{
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+    if (len < 3 || *p++ != frameMagic)
+        return false;
+    uint8_t flags = *p++;
+    uint16_t seq;
+    if (!GetVarint(p, end, seq))
+        return false;
+    uint32_t stamp = 0;
+    if ((flags & FrameFlags_Stamped) && !GetFixed(p, end, stamp, 2))
+        return false;
+    if (flags & FrameFlags_Time)
+    {
+        // an answer to a clock exchange, the request has no robot times
+        uint32_t t1, t2, t3;
+        if (!GetFixed(p, end, t1, 4) || !GetFixed(p, end, t2, 4) || !GetFixed(p, end, t3, 4))
+            return false;
+        if (t2 != 0 || t3 != 0)
+        {
+            Exchanged(t1, t2, t3, usec != 0 ? usec : micros());
+            Answered();
+        }
+        return true;
+    }
+    if (flags & FrameFlags_Stamped)
+        Aged(stamp);
+    if (flags & FrameFlags_Subscribe)
+    {
+        // subscribe frames are not part of the Property sequence
+        if (subFunc == nullptr)
+            return true;
+        func = subFunc;
+    }
+    else
+    {
+        if (haveRx && seq != sequenceRx)
+            stats.lost += (uint16_t)(seq - sequenceRx);
+        haveRx = true;
+        sequenceRx = seq + 1;
+        stats.received++;
+    }
+    while (p < end)
+    {
+        uint16_t entity, property, v;
+        if (!GetVarint(p, end, entity) || !GetVarint(p, end, property) || !GetVarint(p, end, v))
+            return false;
+        (*func)((EntityID)entity, (PropertyID)property, UnZigZag(v));
+    }
+    return true;
+}
+
+void Post(const uint8_t* data, int len, uint32_t usec)
+{
+    if (received == nullptr || len > frameMax)
+        return;
+    Received r;
+    r.usec = usec;
+    r.len = len;
+    memcpy(r.data, data, len);
+    // a frame dropped when the queue is full shows as lost in the sequence
+    xQueueSend(received, &r, 0);
+}
+
+void Poll(sync_cb func)
+{
+#ifdef SYNC_SIM
+    // the simulated robot answers in the control task
+    SimPeer::Loop();
+#endif
+    if (received == nullptr)
+        return;
+    Received r;
+    while (xQueueReceive(received, &r, 0) == pdTRUE)
+        Decode(r.data, r.len, func, nullptr, r.usec);
+}
+
+void Subscribe(const Subscription* list, uint8_t count)
+{
+    if (count > subMax)
+    {
+        floge("Too many Subscriptions");
+        count = subMax;
+    }
+    for (int i = 0; i < count; i++)
+        subStates[i] = { 0, false };
+    portENTER_CRITICAL(&subMux);
+    subs = list;
+    subCount = count;
+    subSent = false;
+    portEXIT_CRITICAL(&subMux);
+}
+
+bool Accept(EntityID entity, PropertyID property)
+{
+    for (int i = 0; i < subCount; i++)
+    {
+        const Subscription& sub = subs[i];
+        if (sub.entity != entity || sub.property != property)
+            continue;
+        SubState& state = subStates[i];
+        unsigned long msec = millis();
+        if (sub.rate != 0 && state.last != 0 && msec - state.last < 1000UL / sub.rate)
+        {
+            // too soon, hold on to it for Deliver
+            state.held = true;
+            stats.throttled++;
+            return false;
+        }
+        state.last = msec;
+        state.held = false;
+        stats.delivered++;
+        return true;
+    }
+    stats.unsubscribed++;
+    return false;
+}
+
+void Deliver(deliver_cb func)
+{
+    unsigned long msec = millis();
+    for (int i = 0; i < subCount; i++)
+    {
+        SubState& state = subStates[i];
+        if (!state.held || msec - state.last < 1000UL / subs[i].rate)
+            continue;
+        state.held = false;
+        state.last = msec;
+        stats.delivered++;
+        (*func)(subs[i].entity, subs[i].property);
+    }
+}
+
+#ifndef SYNC_SIM
+esp_now_recv_cb_t domainReceive = nullptr;  // the Domain's receive callback, for the packets that are not Sync frames
+
+/**
+ * @brief ESP-NOW receive callback, queueing the Sync frames for Poll and passing the rest on to the Domain
+ */
+void OnReceive(const uint8_t* mac, const uint8_t* data, int len)
+{
+    if (len > 0 && data[0] == frameMagic)
+        Post(data, len, micros());
+    else if (domainReceive != nullptr)
+        (*domainReceive)(mac, data, len);
+}
+
+extern "C" esp_err_t __real_esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+
+/**
+ * @brief Stand in for the Domain's receive callback, keeping it for the packets that are not Sync frames
+ * @remarks Linked in place of esp_now_register_recv_cb by -Wl,--wrap, as ESP-NOW has a single receive callback
+ *      and the Domain registers its own as it starts the radio
+ */
+extern "C" esp_err_t __wrap_esp_now_register_recv_cb(esp_now_recv_cb_t cb)
+{
+    domainReceive = cb;
+    return __real_esp_now_register_recv_cb(cb != nullptr ? OnReceive : nullptr);
+}
+#endif
+
+void UseFrames(bool on)
+{
+    offered = on;
+    if (!on)
+        Fallback();
+}
+
+bool Frames()
+{
+    return frames;
+}
+
+/**
+ * @brief Send a frame to the robot
+ */
+void Send(const uint8_t* buf, int len)
+{
+#ifdef SYNC_SIM
+    SimPeer::Receive(buf, len);
+#else
+    if (esp_now_send(peerAddress, buf, len) != ESP_OK)
+        floge("Sync send failed");
+#endif
+    stats.frames++;
+    stats.bytes += len;
+}
+
+/**
+ * @brief Send the request of a clock exchange
+ */
+void SendTime()
+{
+    uint8_t buf[frameMax];
+    uint8_t* p = buf;
+    *p++ = frameMagic;
+    *p++ = FrameFlags_Time;
+    PutVarint(p, 0);
+    // the robot fills in its times as it answers
+    PutFixed(p, micros(), 4);
+    PutFixed(p, 0, 4);
+    PutFixed(p, 0, 4);
+    Send(buf, p - buf);
+}
+
+/**
+ * @brief Send the Subscriptions of the active UI page to the robot
+ */
+void SendSubscriptions()
+{
+    // taken with the list, so a list replaced by the UI meanwhile is sent again
+    portENTER_CRITICAL(&subMux);
+    subSent = true;
+    const Subscription* list = subs;
+    uint8_t count = subCount;
+    portEXIT_CRITICAL(&subMux);
+    uint8_t buf[frameMax];
+    uint8_t* p = buf;
+    *p++ = frameMagic;
+    *p++ = FrameFlags_Subscribe | FrameFlags_Stamped;
+    PutVarint(p, 0);
+    PutFixed(p, Stamp(micros()), 2);
+    for (int i = 0; i < count && p + recordMax <= buf + frameMax; i++)
+    {
+        // the robot has no business sending the controller's own values back
+        if (Owner(list[i].property) != Owner_Robot)
+            continue;
+        PutVarint(p, list[i].entity);
+        PutVarint(p, list[i].property);
+        PutVarint(p, ZigZag(list[i].rate));
+    }
+    Send(buf, p - buf);
+}
+
+void Flush()
+{
+    unsigned long msec = millis();
+    if (frames && msec - timeAnswerLast >= answerTimeout)
+        Fallback();
+    if (!frames)
+    {
+        // offer the frames with a clock exchange, a robot taking them answers it
+        if (offered && msec - timeExchangeLast >= clockInterval)
+        {
+            timeExchangeLast = msec;
+            SendTime();
+        }
+        // hand the coalesced changes to the Domain
+        for (int i = 0; i < slotCount; i++)
+        {
+            Slot& slot = slots[i];
+            if (!slot.dirty)
+                continue;
+            slot.dirty = false;
+            VirtualBot.SetEntityPropertyValue(slot.entity, slot.property, slot.value);
+            stats.updates++;
+        }
+        return;
+    }
+    uint8_t buf[frameMax];
+    bool keyframe = msec - timeKeyframeLast >= keyframeInterval;
+    if (keyframe)
+        timeKeyframeLast = msec;
+    // (re)send the Subscriptions when changed and along with each keyframe in case the robot restarted
+    if (!subSent || keyframe)
+        SendSubscriptions();
+    if (msec - timeExchangeLast >= clockInterval)
+    {
+        timeExchangeLast = msec;
+        SendTime();
+    }
+    int len;
+    // keep sending until all the queued changes have fit
+    while ((len = Encode(buf, keyframe)) > 0)
+    {
+        Send(buf, len);
+        if (keyframe)
+            stats.keyframes++;
+        keyframe = false;
+    }
+}
+
+};
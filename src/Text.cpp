@@ -0,0 +1,151 @@
+#include "Text.h"
+// the built-in 5x8 font, which Adafruit_GFX keeps static to itself
+#include <glcdfont.c>
+
+namespace Text
+{
+const char firstChar = ' ';     // the first character cached
+const char lastChar = '~';      // the last character cached
+const uint8_t glyphRows = 8;    // font rows, each drawn twice
+const uint8_t spanMax = tftWidth / charWidth;   // the most characters in a span
+
+/**
+ * @brief A glyph expanded for drawing
+ */
+struct Glyph
+{
+    bool expanded;              // the rows have been expanded from the font
+    uint16_t rows[glyphRows];   // 12 bits per row, the leftmost pixel in bit 11
+};
+
+Glyph glyphs[lastChar - firstChar + 1];
+
+uint16_t nibbleFg = 0;          // the colors the nibble table was built for
+uint16_t nibbleBg = 0;
+bool nibbleValid = false;
+uint16_t nibbles[16][4];        // the 4 pixels for each 4-bit row fragment
+
+uint16_t rowPixels[spanMax * charWidth];    // one pixel row of a span
+
+/**
+ * @brief Get the expanded glyph for a character, expanding it from the font if needed
+ */
+const Glyph& GetGlyph(char c)
+{
+    if (c < firstChar || c > lastChar)
+        c = '?';
+    Glyph& g = glyphs[c - firstChar];
+    if (!g.expanded)
+    {
+        // the font is 5 columns of 8 bits for each character, the top row in bit 0,
+        // each column is doubled, leaving the 6th column blank
+        const unsigned char* cols = &font[(uint8_t)c * 5];
+        for (uint8_t row = 0; row < glyphRows; row++)
+        {
+            uint16_t bits = 0;
+            for (uint8_t col = 0; col < 5; col++)
+            {
+                if (pgm_read_byte(&cols[col]) & (1 << row))
+                    bits |= 0x0C00 >> (col * 2);
+            }
+            g.rows[row] = bits;
+        }
+        g.expanded = true;
+    }
+    return g;
+}
+
+/**
+ * @brief Make the nibble table ready for a pair of colors
+ */
+void SetColors(uint16_t fg, uint16_t bg)
+{
+    if (nibbleValid && fg == nibbleFg && bg == nibbleBg)
+        return;
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+            nibbles[n][i] = (n & (8 >> i)) ? fg : bg;
+    }
+    nibbleFg = fg;
+    nibbleBg = bg;
+    nibbleValid = true;
+}
+
+void Draw(int16_t x, int16_t y, const char* s, uint8_t n, uint16_t fg, uint16_t bg)
+{
+    if (x < 0 || y < 0 || x >= tftWidth || y + charHeight > tftHeight)
+        return;
+    uint8_t fit = (tftWidth - x) / charWidth;
+    if (n > fit)
+        n = fit;
+    if (n == 0)
+        return;
+    const Glyph* span[spanMax];
+    bool ended = false;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (!ended && s[i] == '\0')
+            ended = true;
+        span[i] = &GetGlyph(ended ? ' ' : s[i]);
+    }
+    SetColors(fg, bg);
+    tft.startWrite();
+    tft.setAddrWindow(x, y, n * charWidth, charHeight);
+    for (uint8_t row = 0; row < glyphRows; row++)
+    {
+        uint16_t* p = rowPixels;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            uint16_t bits = span[i]->rows[row];
+            memcpy(p, nibbles[(bits >> 8) & 0xF], sizeof(nibbles[0]));
+            memcpy(p + 4, nibbles[(bits >> 4) & 0xF], sizeof(nibbles[0]));
+            memcpy(p + 8, nibbles[bits & 0xF], sizeof(nibbles[0]));
+            p += charWidth;
+        }
+        // each font row is two pixel rows
+        tft.writePixels(rowPixels, n * charWidth);
+        tft.writePixels(rowPixels, n * charWidth);
+    }
+    tft.endWrite();
+}
+
+int Print(const char* s, uint16_t fg, uint16_t bg)
+{
+    int16_t x = tft.getCursorX();
+    int16_t y = tft.getCursorY();
+    const char* start = s;
+    while (*s != '\0')
+    {
+        // gather the span to the end of the line or the screen edge
+        uint8_t n = 0;
+        while (s[n] != '\0' && s[n] != '\n' && s[n] != '\r' && x + (n + 1) * charWidth <= tftWidth)
+            n++;
+        if (n > 0)
+        {
+            Draw(x, y, s, n, fg, bg);
+            x += n * charWidth;
+            s += n;
+        }
+        if (*s == '\r')
+        {
+            s++;
+        }
+        else if (*s == '\n')
+        {
+            s++;
+            x = 0;
+            y += charHeight;
+        }
+        else if (*s != '\0')
+        {
+            // wrap at the screen edge
+            x = 0;
+            y += charHeight;
+        }
+    }
+    tft.setCursor(x, y);
+    return s - start;
+}
+
+};
@@ -0,0 +1,172 @@
+#include "Touch.h"
+#include "Power.h"
+
+namespace Touch
+{
+// touch screen calibration: raw x range and raw y range, before rotation
+const int16_t calib[4] = {154, 3812, 276, 3808};
+
+const int16_t slop = 10;            // pixels a touch may wander and still be in place
+const uint16_t longPressMsec = 600; // hold time for a long press
+const uint16_t swipeMsec = 400;     // the most time for a swipe
+const int16_t swipeDistance = 80;   // the least horizontal distance for a swipe
+const uint16_t releaseMsec = 60;    // sample-free time while down before checking for a release
+const uint8_t fifoThreshold = 4;    // samples collected before interrupting
+
+volatile bool irq = false;          // the touchscreen has interrupted
+volatile bool irqSeen = false;      // an interrupt has ever come, so the IRQ line is wired
+
+/**
+ * @brief Touchscreen interrupt handler
+ */
+void IRAM_ATTR TouchISR()
+{
+    irq = true;
+    irqSeen = true;
+    // the UI loop may be resting
+    Power::WakeFromISR();
+}
+
+bool down = false;          // the screen is being touched
+bool dragging = false;      // the touch has become a drag
+bool longPressed = false;   // a long press has been reported for this touch
+Point start;                // where the touch started
+unsigned long timeDown = 0;         // millis() when the touch started
+unsigned long timeSampleLast = 0;   // millis() of the last sample
+
+void Init()
+{
+    pinMode(STMPE_IRQ, INPUT_PULLUP);
+    // interrupt when a few samples have collected and when touched or released
+    ts.writeRegister8(STMPE_FIFO_TH, fifoThreshold);
+    ts.writeRegister8(STMPE_INT_EN, STMPE_INT_EN_TOUCHDET | STMPE_INT_EN_FIFOTH);
+    ts.writeRegister8(STMPE_INT_CTRL, STMPE_INT_CTRL_POL_LOW | STMPE_INT_CTRL_EDGE | STMPE_INT_CTRL_ENABLE);
+    ts.writeRegister8(STMPE_INT_STA, 0xFF);
+    attachInterrupt(digitalPinToInterrupt(STMPE_IRQ), TouchISR, FALLING);
+}
+
+bool Down()
+{
+    return down;
+}
+
+/**
+ * @brief Drain the sample FIFO, averaging the valid samples into one screen point
+ *
+ * @param pt Receives the calibrated screen point
+ * @return true if there were valid samples
+ */
+bool ReadBurst(Point& pt)
+{
+    int32_t sumX = 0;
+    int32_t sumY = 0;
+    uint8_t n = 0;
+    for (uint8_t count = ts.bufferSize(); count > 0; count--)
+    {
+        uint16_t x, y;
+        uint8_t z;
+        ts.readData(&x, &y, &z);
+        // samples at the extremes are noise from a touch starting or ending
+        if (x < calib[2] / 2 || x > 4095 - calib[2] / 2 || y < calib[0] / 2 || y > 4095 - calib[0] / 2)
+            continue;
+        sumX += x;
+        sumY += y;
+        n++;
+    }
+    if (n == 0)
+        return false;
+    // flip X and Y for the current rotation and scale to the screen using the calibration #'s
+    int32_t x = ((sumY / n) - calib[0]) * tftWidth / (calib[1] - calib[0]);
+    int32_t y = ((sumX / n) - calib[2]) * tftHeight / (calib[3] - calib[2]);
+    // invert Y axis
+    pt.x = constrain(x, 0, tftWidth - 1);
+    pt.y = constrain(tftHeight - y, 0, tftHeight - 1);
+    return true;
+}
+
+/**
+ * @brief Report a gesture
+ */
+inline void Report(touch_cb func, TouchGestures gesture, const Point& pt)
+{
+    TouchEvent e = { gesture, pt.x, pt.y, (int16_t)(pt.x - start.x), (int16_t)(pt.y - start.y) };
+    (*func)(e);
+}
+
+Point last;     // the latest touch point
+
+/**
+ * @brief Track a new touch point
+ */
+void Sample(const Point& pt, unsigned long msec, touch_cb func)
+{
+    timeSampleLast = msec;
+    last = pt;
+    if (!down)
+    {
+        down = true;
+        dragging = false;
+        longPressed = false;
+        start = pt;
+        timeDown = msec;
+        return;
+    }
+    if (!dragging && (abs(pt.x - start.x) > slop || abs(pt.y - start.y) > slop))
+    {
+        dragging = true;
+        Report(func, Touch_DragStart, pt);
+    }
+    if (dragging)
+        Report(func, Touch_Drag, pt);
+}
+
+/**
+ * @brief End a touch, reporting a tap, swipe or the end of a drag
+ */
+void Release(unsigned long msec, touch_cb func)
+{
+    if (!down)
+        return;
+    down = false;
+    if (dragging)
+    {
+        Report(func, Touch_DragEnd, last);
+        int16_t dx = last.x - start.x;
+        int16_t dy = last.y - start.y;
+        if (msec - timeDown <= swipeMsec && abs(dx) >= swipeDistance && abs(dx) > 2 * abs(dy))
+            Report(func, dx < 0 ? Touch_SwipeLeft : Touch_SwipeRight, last);
+    }
+    else if (!longPressed)
+    {
+        Report(func, Touch_Tap, start);
+    }
+}
+
+void Loop(touch_cb func)
+{
+    unsigned long msec = millis();
+    // without the IRQ jumper no interrupt ever comes, so until one does the FIFO is polled
+    if (irq || (!irqSeen && !ts.bufferEmpty()))
+    {
+        irq = false;
+        ts.writeRegister8(STMPE_INT_STA, 0xFF);
+        Point pt;
+        if (ReadBurst(pt))
+            Sample(pt, msec, func);
+        else if (!ts.touched())
+            Release(msec, func);
+        return;
+    }
+    if (!down)
+        return;
+    if (!dragging && !longPressed && msec - timeDown >= longPressMsec)
+    {
+        longPressed = true;
+        Report(func, Touch_LongPress, last);
+    }
+    // the release interrupt may have come with the last samples
+    if (msec - timeSampleLast >= releaseMsec && !ts.touched())
+        Release(msec, func);
+}
+
+};
@@ -0,0 +1,192 @@
+#include "Trace.h"
+#include "State.h"
+#include <atomic>
+
+namespace Trace
+{
+/**
+ * @brief A queued trace record
+ */
+struct Record
+{
+    uint32_t usec;
+    uint8_t kind;
+    uint8_t a;
+    uint8_t b;
+    int16_t value;
+};
+
+const uint16_t queueMax = 512;  // records queued, a power of 2
+const uint8_t frameRecords = 32;    // records per Serial frame
+const uint8_t recordSize = 9;   // bytes per record on the wire
+const uint8_t selectMax = 8;    // the most Properties sampled
+
+Record queue[queueMax];
+std::atomic<uint16_t> queueHead(0);     // next slot to write, owned by the producers
+portMUX_TYPE putMux = portMUX_INITIALIZER_UNLOCKED; // serializes the producers on both cores
+std::atomic<uint16_t> queueTail(0);     // next slot to read, owned by the drain task
+std::atomic<uint32_t> dropped(0);
+std::atomic<bool> active(false);
+
+struct Selection
+{
+    EntityID entity;
+    PropertyID property;
+};
+
+Selection selections[selectMax];
+uint8_t selectCount = 0;
+
+uint32_t interval = 1000000 / rateDefault;  // usec between Property samples
+uint32_t timeSampleLast = 0;
+
+bool Active()
+{
+    return active.load(std::memory_order_relaxed);
+}
+
+uint32_t Dropped()
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Queue a record for the drain task
+ * @remarks Both the control task and the UI loop call this, so producers take turns
+ */
+void Put(uint8_t kind, uint8_t a, uint8_t b, int16_t value)
+{
+    if (!Active())
+        return;
+    uint32_t usec = micros();
+    portENTER_CRITICAL(&putMux);
+    uint16_t head = queueHead.load(std::memory_order_relaxed);
+    uint16_t next = (head + 1) & (queueMax - 1);
+    if (next == queueTail.load(std::memory_order_acquire))
+    {
+        portEXIT_CRITICAL(&putMux);
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue[head] = { usec, kind, a, b, value };
+    queueHead.store(next, std::memory_order_release);
+    portEXIT_CRITICAL(&putMux);
+}
+
+void Select(EntityID entity, PropertyID property)
+{
+    if (selectCount < selectMax)
+        selections[selectCount++] = { entity, property };
+}
+
+void SetRate(uint16_t hz)
+{
+    interval = 1000000 / constrain(hz, 1, 1000);
+}
+
+void Loop()
+{
+    if (!Active())
+        return;
+    uint32_t usec = micros();
+    if (usec - timeSampleLast < interval)
+        return;
+    timeSampleLast = usec;
+    for (int i = 0; i < selectCount; i++)
+    {
+        Selection& sel = selections[i];
+        Put(Kind_Property, sel.entity, sel.property, State::Get(sel.entity, sel.property));
+    }
+}
+
+void Stage(Profiler::Sections section, uint32_t usec)
+{
+    Put(Kind_Stage, section, 0, (int16_t)min(usec, (uint32_t)INT16_MAX));
+}
+
+void Key(PadKeys btn, int16_t x, int16_t y)
+{
+    Put(Kind_Pad, btn, 0, x);
+    if (btn == PadKeys_leftStick || btn == PadKeys_rightStick)
+        Put(Kind_Pad, btn, 1, y);
+}
+
+/**
+ * @brief Check for host commands to start or stop streaming
+ */
+void CheckHost()
+{
+    while (Serial.available() > 0)
+    {
+        switch (Serial.read())
+        {
+        case 'b':
+            queueTail.store(queueHead.load(std::memory_order_acquire), std::memory_order_release);
+            active.store(true);
+            break;
+        case 't':
+            active.store(false);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Drain queued records to Serial in frames
+ */
+void DrainTask(void*)
+{
+    uint8_t frame[3 + frameRecords * recordSize + 1];
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        CheckHost();
+        uint16_t tail = queueTail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            uint16_t head = queueHead.load(std::memory_order_acquire);
+            if (tail == head)
+                break;
+            uint8_t* p = frame + 3;
+            uint8_t n = 0;
+            uint8_t check = 0;
+            for (; n < frameRecords && tail != head; n++, tail = (tail + 1) & (queueMax - 1))
+            {
+                const Record& r = queue[tail];
+                uint8_t* rec = p;
+                *p++ = r.usec;
+                *p++ = r.usec >> 8;
+                *p++ = r.usec >> 16;
+                *p++ = r.usec >> 24;
+                *p++ = r.kind;
+                *p++ = r.a;
+                *p++ = r.b;
+                *p++ = r.value;
+                *p++ = r.value >> 8;
+                for (; rec < p; rec++)
+                    check ^= *rec;
+            }
+            // release the slots before the (possibly blocking) write
+            queueTail.store(tail, std::memory_order_release);
+            frame[0] = sync0;
+            frame[1] = sync1;
+            frame[2] = n;
+            *p++ = check;
+            Serial.write(frame, p - frame);
+        }
+    }
+}
+
+void Init()
+{
+    // the Goal vs RPM traces previously plotted with Teleplot
+    for (EntityID entity = EntityID_LeftMotor; entity <= EntityID_RearMotor; entity++)
+    {
+        Select(entity, PropertyID_Goal);
+        Select(entity, PropertyID_RPM);
+    }
+    // lowest useful priority, below the control task on its core and away from the UI
+    xTaskCreatePinnedToCore(DrainTask, "Trace", 3072, nullptr, 1, nullptr, 0);
+}
+
+};
@@ -1,5 +1,3 @@
-#include <SdFat.h>                // SD card & FAT filesystem library
-#include <Adafruit_SPIFlash.h>    // SPI / QSPI flash library
 #include "Flogger.h"
 #include "PSXPad.h"
 #include "Controller.h"
@@ -8,6 +6,21 @@
 #include "MotorBase.h"
 #include "HeadBase.h"
 #include "NavLightsBase.h"
+#include "Sync.h"
+#include "History.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include "Touch.h"
+#include "Drive.h"
+#include "Scene.h"
+#include "Text.h"
+#include "Assets.h"
+#include "Profiles.h"
+#include "Macro.h"
+#include "State.h"
+#include "Bench.h"
+#include "Boot.h"
+#include "Power.h"
 
 //
 // NOTE: These Entities might best be declared within the Domain subclass,
@@ -37,6 +50,22 @@ Domain VirtualBot = Domain(false, entities);
 
 uint8_t botMacAddress[] = {0xE8, 0x9F, 0x6D, 0x32, 0xDE, 0x2C};
 
+/**
+ * @brief Filters for the jittery telemetry, so small wobbles are not redrawn
+ */
+const TelemetryFilter telemetryFilters[] =
+{
+    //  entity                property              deadband quantum interval
+    { EntityID_Head,       PropertyID_Position,    1,      2,      50 },   // a resolution of 2
+    { EntityID_Head,       PropertyID_Power,       0,      0,      50 },
+    { EntityID_LeftMotor,  PropertyID_RPM,         1,      0,      50 },
+    { EntityID_RightMotor, PropertyID_RPM,         1,      0,      50 },
+    { EntityID_RearMotor,  PropertyID_RPM,         1,      0,      50 },
+    { EntityID_LeftMotor,  PropertyID_Power,       0,      0,      50 },
+    { EntityID_RightMotor, PropertyID_Power,       0,      0,      50 },
+    { EntityID_RearMotor,  PropertyID_Power,       0,      0,      50 },
+};
+
 /**
  * @brief each menu item activates a different UI page
  * 
@@ -44,12 +73,42 @@ uint8_t botMacAddress[] = {0xE8, 0x9F, 0x6D, 0x32, 0xDE, 0x2C};
 enum MenuItems
 {
     Menu_Telemetry, // show robot telemetry
+    Menu_Drive,     // touchscreen robot control
     Menu_Echo,      // show PSX activity
     Menu_Log,       // show flog messages
-    Menu_TBD
+    Menu_Profiler,  // show loop timing
 };
 
-Adafruit_GFX_Button menu[4];    // menu buttons for the MenuItems
+/**
+ * @brief Activate the Log UI page
+ */
+void LogActivate()
+{
+    // no robot telemetry is shown
+    Sync::Subscribe(nullptr, 0);
+    // log lines wrap anywhere above the menu buttons
+    Scene::Opaque(HX8357_BLACK);
+    tft.setCursor(0, 0);
+    // how long startup took, and the power drawn since
+    Boot::Report();
+    Power::Report();
+    // the link traffic so far, echoes suppressed against values sent
+    Sync::Report();
+}
+
+/**
+ * @brief The UI pages, in MenuItems order
+ */
+const Page pages[menuItems] =
+{
+    { "TELEM", Controller::Activate, Controller::Deactivate, Controller::ProcessChartKey, Controller::ProcessChange, nullptr },
+    { "DRIVE", Drive::Activate,      Drive::Deactivate,      nullptr,                     nullptr,                   Drive::ProcessTouch },
+    { "ECHO",  Echo::Activate,       Echo::Deactivate,       Echo::ProcessKey,            nullptr,                   nullptr },
+    { "LOG",   LogActivate,          nullptr,                nullptr,                     nullptr,                   nullptr },
+    { "PROF",  Profiler::Activate,   Profiler::Deactivate,   nullptr,                     nullptr,                   nullptr },
+};
+
+Adafruit_GFX_Button menu[menuItems];    // menu buttons for the MenuItems
 MenuItems menuItem = Menu_Log;  // active UI page
 
 /**
@@ -63,36 +122,12 @@ void SelectMenuItem(MenuItems newItem)
     {
         // deactivate the old item
         menu[menuItem].drawButton(false);
-        switch (menuItem)
-        {
-        case Menu_Echo:
-            Echo::Deactivate();
-            break;
-        case Menu_Telemetry:
-            Controller::Deactivate();
-            break;
-        case Menu_Log:
-        case Menu_TBD:
-            break;
-        }
-        // activate the new item
+        if (pages[menuItem].deactivate != nullptr)
+            (*pages[menuItem].deactivate)();
+        // activate the new item, which repaints only what differs from the old
         menuItem = newItem;
         menu[menuItem].drawButton(true);
-        tft.setTextColor(HX8357_WHITE);
-        tft.setCursor(0,0);
-        switch (menuItem)
-        {
-        case Menu_Echo:
-            Echo::Activate();
-            break;
-        case Menu_Telemetry:
-            Controller::Activate();
-            break;
-        case Menu_Log:
-        case Menu_TBD:
-            tft.fillRect(0, 0, tftWidth, menuY, HX8357_BLACK);
-            break;
-        }
+        (*pages[menuItem].activate)();
     }
 }
 
@@ -101,30 +136,32 @@ void SelectMenuItem(MenuItems newItem)
  */
 void SelectNextMenuItem()
 {
-    switch (menuItem)
-    {
-    case Menu_Telemetry:
-        SelectMenuItem(Menu_Echo);
-        break;
-    case Menu_Echo:
-        SelectMenuItem(Menu_Log);
-        break;
-    case Menu_Log:
-    default:
-        SelectMenuItem(Menu_Telemetry);
-        break;
-    }
+    SelectMenuItem((MenuItems)((menuItem + 1) % menuItems));
 }
 
-SdFat SD;   // images for the Echo UI page are loaded from the SD card
-Adafruit_ImageReader reader(SD);
+/**
+ * @brief Return to the previous UI page
+ */
+void SelectPrevMenuItem()
+{
+    SelectMenuItem((MenuItems)((menuItem + menuItems - 1) % menuItems));
+}
 
 // Init screen on hardware SPI, HX8357D type:
-Adafruit_HX8357 tft = Adafruit_HX8357(TFT_CS, TFT_DC);
+Display tft = Display(TFT_CS, TFT_DC);
 Adafruit_STMPE610 ts = Adafruit_STMPE610(STMPE_CS);
 
-int16_t calib[4] = {154, 3812, 276, 3808};  // touch screen calibration
-TS_Point lastTSpt;  // the last screen point touched
+
+//
+// flog messages come from both cores, and the radio, but only the UI loop draws,
+// so messages for the log UI page wait in a ring, each whole and terminated by '\0'
+//
+const uint16_t logMax = 1024;       // ring bytes, a power of 2
+const uint8_t logLineMax = 128;     // the longest message shown
+char logRing[logMax];
+uint16_t logHead = 0;               // next byte to write
+uint16_t logTail = 0;               // next byte to read
+portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
 
 /**
  * @brief Replacement print function for flog
@@ -134,21 +171,68 @@ TS_Point lastTSpt;  // the last screen point touched
  */
 int flog_printer(const char* s)
 {
-    int len = Serial.print(s);
+    // keep text out of the binary trace stream
+    int len = Trace::Active() ? strlen(s) : Serial.print(s);
     // echo the message only if the log UI is active
     if (menuItem != Menu_Log)
         return len;
-    // 12x16 characters
-    int16_t y = tft.getCursorY();
-    // cycle back to the top once the menu buttons are reached
-    if (y >= menuY - charHeight * 2)
+    // the message goes whole or not at all
+    uint16_t size = strlen(s) + 1;
+    portENTER_CRITICAL(&logMux);
+    uint16_t used = (logHead - logTail) & (logMax - 1);
+    if (used + size < logMax)
+    {
+        for (uint16_t i = 0; i < size; i++)
+        {
+            logRing[logHead] = s[i];
+            logHead = (logHead + 1) & (logMax - 1);
+        }
+    }
+    portEXIT_CRITICAL(&logMux);
+    return len;
+}
+
+/**
+ * @brief Draw the messages waiting for the log UI page
+ */
+void DrainLog()
+{
+    char line[logLineMax];
+    for (;;)
     {
-        tft.setCursor(0, 0);
-        y = 0;
+        int n = 0;
+        bool whole = false;
+        portENTER_CRITICAL(&logMux);
+        while (logTail != logHead)
+        {
+            char c = logRing[logTail];
+            logTail = (logTail + 1) & (logMax - 1);
+            if (c == '\0')
+            {
+                whole = true;
+                break;
+            }
+            if (n < logLineMax - 1)
+                line[n++] = c;
+        }
+        portEXIT_CRITICAL(&logMux);
+        if (!whole)
+            return;
+        line[n] = '\0';
+        if (menuItem != Menu_Log)
+            continue;
+        // 12x16 characters
+        int16_t y = tft.getCursorY();
+        // cycle back to the top once the menu buttons are reached
+        if (y >= menuY - charHeight * 2)
+        {
+            tft.setCursor(0, 0);
+            y = 0;
+        }
+        // clear this line and the next for clarity
+        tft.fillRect(0, y, tftWidth, 2*16, HX8357_BLACK);
+        Text::Print(line, HX8357_WHITE, HX8357_BLACK);
     }
-    // clear this line and the next for clarity
-    tft.fillRect(0, y, tftWidth, 2*16, HX8357_BLACK);
-    return tft.print(s);
 }
 
 /**
@@ -156,122 +240,365 @@ int flog_printer(const char* s)
  */
 void DrawMenuButtons()
 {
-    for (int i = Menu_Telemetry; i <= Menu_TBD; i++)
+    for (int i = 0; i < menuItems; i++)
     {
         int16_t x = i * menuItemWidth;
-        const char* label;
-        switch (i)
-        {
-        case Menu_Telemetry: label = "TELEM"; break;
-        case Menu_Echo:      label = "ECHO";  break;
-        case Menu_Log:       label = "LOG";   break;
-        case Menu_TBD:       label = "TBD";   break;
-        }
-        menu[i].initButtonUL(&tft, x, menuY, menuItemWidth, menuItemHeight, HX8357_WHITE, RGBto565(0x50,0x50,0x50), RGBto565(0xB0,0xB0,0xB0), (char*)label, 2);
+        menu[i].initButtonUL(&tft, x, menuY, menuItemWidth, menuItemHeight, HX8357_WHITE, RGBto565(0x50,0x50,0x50), RGBto565(0xB0,0xB0,0xB0), (char*)pages[i].label, 2);
         menu[i].drawButton();
     }
 }
 
-void setup(void)
+//
+// the control path, Pad, Controller and the Domain sync, runs in its own task on core 0,
+// with the radio, and the UI renders in loop() on core 1, so drawing never delays control
+// the control tick period follows the Power mode
+//
+const uint32_t controlStack = 6144;
+const UBaseType_t controlPriority = 2;      // above the Trace task sharing the core
+const BaseType_t controlCore = 0;
+
+/**
+ * @brief PSX key activity passed from the control task to the active UI page
+ */
+struct KeyEvent
 {
-    FLogger::setPrinter(&flog_printer);
-    FLogger::setLogLevel(FLOG_DEBUG);
-    Serial.begin(115200);
-    delay(2000);    // wait a bit for the computer connection
+    PadKeys btn;
+    int16_t x;
+    int16_t y;
+};
+
+const uint8_t uiKeyMax = 32;    // key events waiting for the UI
+QueueHandle_t uiKeys = nullptr;
+
+/**
+ * @brief Process PSX key activity, in the control task
+ */
+void PadCallback(PadKeys btn, int16_t x, int16_t y)
+{
+    Power::Activity();
+    Trace::Key(btn, x, y);
+    // the UI page takes its keys in loop()
+    KeyEvent e = { btn, x, y };
+    xQueueSend(uiKeys, &e, 0);
+    // recording, or ignoring live control while a recording plays
+    if (Macro::ProcessKey(btn, x, y))
+        Controller::ProcessKey(btn, x, y);
+}
+
+/**
+ * @brief Replay recorded control activity through the live path
+ */
+void PlaybackCallback(PadKeys btn, int16_t x, int16_t y)
+{
+    Power::Activity();
+    Trace::Key(btn, x, y);
+    Controller::ProcessKey(btn, x, y);
+}
 
-    tft.begin();    // initialize screen
+/**
+ * @brief Record a robot Property change in the State, in the control task
+ * 
+ * @param entity the ID of the Entity
+ * @param property the ID of the changed Property
+ * @param v the new value
+ */
+void ReceiveChange(EntityID entity, PropertyID property, int16_t v)
+{
+    // the controller's own values are shown as set, their echoes from the robot are dropped,
+    // and the jittery telemetry is filtered
+    if (Sync::Receive(entity, property, v))
+        State::Set(entity, property, v);
+}
+
+/**
+ * @brief Record a robot Property change from the Domain
+ * 
+ * @param pe pointer to the Entity
+ * @param pp pointer to the changed Property
+ */
+void ChgCallback(Entity* pe, Property* pp)
+{
+    ReceiveChange(pe->GetID(), pp->GetID(), pp->Get());
+}
+
+/**
+ * @brief The control task, ticking at a fixed rate
+ */
+void ControlTask(void* arg)
+{
+    TickType_t wake = xTaskGetTickCount();
+    for (;;)
+    {
+        Profiler::Tick(Power::Wait(wake));
+        {
+            Profiler::Scope scope(Profiler::Section_Pad);
+            Pad::Loop(&PadCallback);
+            Drive::Loop(&PadCallback);
+            Macro::Loop(&PlaybackCallback);
+            // one command from all the inputs of the tick
+            Controller::Loop();
+        }
+        {
+            Profiler::Scope scope(Profiler::Section_Sync);
+            // send the Property changes from this control tick together
+            Sync::Flush();
+        }
+        {
+            Profiler::Scope scope(Profiler::Section_Changes);
+            // the robot's changes, from Sync frames and from the Domain
+            Sync::Poll(&ReceiveChange);
+            VirtualBot.ProcessChanges(&ChgCallback);
+            Sync::Settle(&State::Set);
+            // one consistent snapshot per tick for the UI
+            State::Publish();
+        }
+        Power::Ticked();
+    }
+}
+
+/**
+ * @brief Boot stage: the screen, blank
+ */
+void InitScreen()
+{
+    tft.begin();
     tft.setRotation(1);
     tft.fillScreen(HX8357_BLACK);
     tft.setTextSize(2);
-    flogi("TFT init");
+}
 
-    flogi("Touchscreen init");
+/**
+ * @brief Boot stage: the touchscreen, on the screen's SPI bus
+ */
+void InitTouch()
+{
     if (!ts.begin())
         flogf("%s FAILED", "Touchscreen init");
+    else
+        Touch::Init();
+}
 
-    flogi("SD init");
-    // ESP32 requires 25 MHz limit
-    if (!SD.begin(SD_CS, SD_SCK_MHZ(25)))
-        flogf("%s FAILED", "SD init");
+/**
+ * @brief Boot stage: the images for the Echo UI page, packed in flash
+ */
+void InitAssets()
+{
+    Assets::Init();
+}
 
+/**
+ * @brief Boot stage: the SeeSaw knobs and PSX controller
+ */
+void InitInputs()
+{
+    // control parameters, before the inputs that use them
+    Profiles::Init();
     Pad::Init();
+}
 
-    VirtualBot.Init(botMacAddress);     // starts WiFi and ESP_NOW
+/**
+ * @brief Boot stage: WiFi and ESP_NOW
+ */
+void InitRadio()
+{
+    VirtualBot.Init(botMacAddress);
+    // Sync frames to and from the robot once it answers them, false to keep to the Domain's messages
+    Sync::UseFrames(true);
+}
 
-    DrawMenuButtons();
-    delay(1000);
+void setup(void)
+{
+    FLogger::setPrinter(&flog_printer);
+    FLogger::setLogLevel(FLOG_DEBUG);
+    // no waiting for the computer connection, the boot timeline is kept for the LOG page
+    Serial.begin(115200);
+
+    // the robot link is ready for the UI's subscriptions before the radio is
+    Sync::Init(botMacAddress);
+    Sync::Filter(telemetryFilters, sizeof(telemetryFilters) / sizeof(TelemetryFilter));
+
+    // the radio and the I2C and PSX inputs wait on their hardware on the control core
+    // while the screen comes up here
+    Boot::Start("radio", &InitRadio);
+    Boot::Start("inputs", &InitInputs);
+    Boot::Run("screen", &InitScreen);
+    Boot::Run("touch", &InitTouch);
+    Boot::Run("assets", &InitAssets);
+    Trace::Init();
+
+#ifdef BENCH
+    // the hot path benchmarks, on the inputs, before the pages take the screen
+    Boot::Join();
+    if (!Bench::Run())
+        flogf("%s FAILED", "bench");
+#endif
 
+    // the UI is up before the robot link
+    DrawMenuButtons();
     SelectMenuItem(Menu_Telemetry);
+    Boot::Mark("ui");
+
+    Boot::Join();
+
+    // the UI task rests between control ticks, setup runs in it
+    Power::Init();
+    uiKeys = xQueueCreate(uiKeyMax, sizeof(KeyEvent));
+    xTaskCreatePinnedToCore(ControlTask, "Control", controlStack, nullptr, controlPriority, nullptr, controlCore);
+    Boot::Mark("drivable");
 
-    flogi("completed");
+    Boot::Report();
 }
 
 unsigned long timeInputLast = 0;
-unsigned long timePlotLast = 0;
 
-void PadCallback(PadKeys btn, int16_t x, int16_t y)
+/**
+ * @brief Pass the PSX key activity from the control task to the active UI page
+ */
+void ProcessKeys()
 {
-    if (menuItem == Menu_Echo)
-        Echo::ProcessKey(btn, x, y);
-    switch (btn)
+    KeyEvent e;
+    while (xQueueReceive(uiKeys, &e, 0) == pdTRUE)
     {
-    case PadKeys_select:
-        if (x != 0)
-            SelectNextMenuItem();
-        break;
+        if (pages[menuItem].processKey != nullptr)
+            (*pages[menuItem].processKey)(e.btn, e.x, e.y);
+        switch (e.btn)
+        {
+        case PadKeys_select:
+            if (e.x != 0)
+                SelectNextMenuItem();
+            break;
+        }
     }
-    Controller::ProcessKey(btn, x, y);
 }
 
-void ChgCallback(Entity* pe, Property* pp)
+/**
+ * @brief Pass a robot Property change to the active UI page
+ * 
+ * @param entity the ID of the Entity
+ * @param property the ID of the changed Property
+ */
+void DeliverChange(EntityID entity, PropertyID property)
 {
-    if (menuItem == Menu_Telemetry)
-        Controller::ProcessChange(pe, pp);
+    if (pages[menuItem].processChange != nullptr)
+        (*pages[menuItem].processChange)(entity, property, State::Get(entity, property));
 }
 
-void loop()
+/**
+ * @brief Process a change in the State snapshot
+ * 
+ * @param entity the ID of the Entity
+ * @param property the ID of the changed Property
+ * @param v the new value
+ */
+void StateChange(EntityID entity, PropertyID property, int16_t v)
+{
+    // the controller's own state is not the robot's to subscribe to
+    if (entity == EntityID_None)
+    {
+        if (pages[menuItem].processChange != nullptr)
+            (*pages[menuItem].processChange)(entity, property, v);
+        return;
+    }
+    // only changes the active UI page subscribed to, at the rate it asked for
+    if (Sync::Accept(entity, property))
+        DeliverChange(entity, property);
+}
+
+bool pageDrag = false;  // the drag in progress started on the UI page
+
+/**
+ * @brief Process touchscreen gestures
+ * 
+ * @param e The gesture event
+ */
+void TouchCallback(const TouchEvent& e)
 {
-    unsigned long msec = millis();
-    // time slice for processing UI inputs and changes from the robot
-    unsigned long dmsec = msec - timeInputLast;
-    if (dmsec >= 20)
+    Power::Activity();
+    bool toPage;
+    switch (e.gesture)
     {
-        timeInputLast = msec;
-        if (!ts.bufferEmpty())
+    case Touch_DragStart:
+        // a drag stays with where it started, wherever it is released,
+        // so a stick dragged off over the menu still springs back
+        pageDrag = pages[menuItem].processTouch != nullptr && e.y - e.dy < menuY;
+        // fall through
+    case Touch_Drag:
+    case Touch_DragEnd:
+    case Touch_SwipeLeft:
+    case Touch_SwipeRight:
+        toPage = pageDrag;
+        break;
+    default:
+        toPage = pages[menuItem].processTouch != nullptr && e.y < menuY;
+        break;
+    }
+    if (toPage)
+    {
+        // the page takes the gestures, as when the touchscreen drives the robot
+        if (pages[menuItem].processTouch != nullptr)
+            (*pages[menuItem].processTouch)(e);
+        return;
+    }
+    switch (e.gesture)
+    {
+    case Touch_Tap:
+        // select any menu item tapped
+        for (int i = 0; i < menuItems; i++)
         {
-            TS_Point p = ts.getPoint();
-            if (p != lastTSpt)
+            if (menu[i].contains(e.x, e.y))
             {
-                lastTSpt = p;
-                // flip X and Y for the current rotation
-                int16_t x = p.y;
-                int16_t y = p.x;
-                // Scale to tftWidth using the calibration #'s
-                x = map(x, calib[0], calib[1], 0, tftWidth);
-                y = map(y, calib[2], calib[3], 0, tftHeight);
-                // invert Y axis
-                y = tftHeight - y;
-                tft.fillCircle(x, y, 3, HX8357_MAGENTA);
-                //Serial.print("("); Serial.print(p.x); Serial.print(","); Serial.print(p.y); Serial.println(")");
-                MenuItems newItem = menuItem;
-                for (int i = Menu_Telemetry; i <= Menu_TBD; i++)
-                {
-                    if (menu[i].contains(x, y))
-                    {
-                        SelectMenuItem((MenuItems)i);
-                        break;
-                    }
-                }
+                SelectMenuItem((MenuItems)i);
+                break;
             }
         }
-        Pad::Loop(&PadCallback);
+        break;
+    case Touch_SwipeLeft:
+        SelectNextMenuItem();
+        break;
+    case Touch_SwipeRight:
+        SelectPrevMenuItem();
+        break;
     }
-    VirtualBot.ProcessChanges(&ChgCallback);
-    // time slice for processing debug data plots
-    dmsec = msec - timePlotLast;
-    if (dmsec >= 1000)
+}
+
+void loop()
+{
+    Profiler::LoopStart();
     {
-        timePlotLast = msec;
-        Controller::DoPlot();
+        Profiler::Scope scope(Profiler::Section_Loop);
+        unsigned long msec = millis();
+        // time slice for the touchscreen, which shares the SPI bus with the screen, and the charts
+        unsigned long dmsec = msec - timeInputLast;
+        if (dmsec >= 20)
+        {
+            timeInputLast = msec;
+            {
+                Profiler::Scope scope(Profiler::Section_Touch);
+                Touch::Loop(&TouchCallback);
+            }
+            {
+                Profiler::Scope scope(Profiler::Section_History);
+                // each sample due while the loop rested is charted
+                uint8_t tiers;
+                while ((tiers = History::Loop()) != 0)
+                    Controller::ProcessHistory(tiers);
+            }
+            Drive::Render();
+        }
+        ProcessKeys();
+        // the changes published by the control task
+        if (State::Read())
+            State::Diff(&StateChange);
+        Sync::Deliver(&DeliverChange);
+        // a Profile selected on the control task, stored off it
+        Profiles::Save();
+        {
+            Profiler::Scope scope(Profiler::Section_Trace);
+            Trace::Loop();
+        }
+        DrainLog();
     }
+    Profiler::Loop();
+    // nothing to do until the next control tick or a touch
+    Power::Rest();
 }
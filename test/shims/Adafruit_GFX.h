@@ -0,0 +1,261 @@
+#ifndef _HOST_ADAFRUIT_GFX_H
+#define _HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+#include <glcdfont.c>
+
+/**
+ * @brief Adafruit_GFX for the host tests, with the library's shape algorithms
+ * @remarks The shapes break down into the same pixel, line and rectangle writes as the library's,
+ *      so a display counting those counts the same work as on the device.
+ */
+class Adafruit_GFX : public Print
+{
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color) { drawPixel(x, y, color); }
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        for (int16_t i = x; i < x + w; i++)
+            writeFastVLine(i, y, h, color);
+    }
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+    {
+        for (int16_t j = y; j < y + h; j++)
+            writePixel(x, j, color);
+    }
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+    {
+        for (int16_t i = x; i < x + w; i++)
+            writePixel(i, y, color);
+    }
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        startWrite();
+        writeFillRect(x, y, w, h, color);
+        endWrite();
+    }
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+    {
+        startWrite();
+        writeFastVLine(x, y, h, color);
+        endWrite();
+    }
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+    {
+        startWrite();
+        writeFastHLine(x, y, w, color);
+        endWrite();
+    }
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        startWrite();
+        writeFastHLine(x, y, w, color);
+        writeFastHLine(x, y + h - 1, w, color);
+        writeFastVLine(x, y, h, color);
+        writeFastVLine(x + w - 1, y, h, color);
+        endWrite();
+    }
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+    {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+        startWrite();
+        writePixel(x0, y0 + r, color);
+        writePixel(x0, y0 - r, color);
+        writePixel(x0 + r, y0, color);
+        writePixel(x0 - r, y0, color);
+        while (x < y)
+        {
+            if (f >= 0)
+            {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            writePixel(x0 + x, y0 + y, color);
+            writePixel(x0 - x, y0 + y, color);
+            writePixel(x0 + x, y0 - y, color);
+            writePixel(x0 - x, y0 - y, color);
+            writePixel(x0 + y, y0 + x, color);
+            writePixel(x0 - y, y0 + x, color);
+            writePixel(x0 + y, y0 - x, color);
+            writePixel(x0 - y, y0 - x, color);
+        }
+        endWrite();
+    }
+
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+    {
+        startWrite();
+        writeFastVLine(x0, y0 - r, 2 * r + 1, color);
+        fillCircleHelper(x0, y0, r, 3, 0, color);
+        endWrite();
+    }
+
+    void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color)
+    {
+        int16_t f = 1 - r;
+        int16_t ddF_x = 1;
+        int16_t ddF_y = -2 * r;
+        int16_t x = 0;
+        int16_t y = r;
+        int16_t px = x;
+        int16_t py = y;
+        delta++;
+        while (x < y)
+        {
+            if (f >= 0)
+            {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            if (x < y + 1)
+            {
+                if (corners & 1)
+                    writeFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+                if (corners & 2)
+                    writeFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+            }
+            if (y != py)
+            {
+                if (corners & 1)
+                    writeFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+                if (corners & 2)
+                    writeFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+                py = y;
+            }
+            px = x;
+        }
+    }
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+    {
+        startWrite();
+        for (int8_t i = 0; i < 5; i++)
+        {
+            uint8_t line = font[c * 5 + i];
+            for (int8_t j = 0; j < 8; j++, line >>= 1)
+            {
+                if (line & 1)
+                    size == 1 ? writePixel(x + i, y + j, color) : writeFillRect(x + i * size, y + j * size, size, size, color);
+                else if (bg != color)
+                    size == 1 ? writePixel(x + i, y + j, bg) : writeFillRect(x + i * size, y + j * size, size, size, bg);
+            }
+        }
+        if (bg != color)
+            size == 1 ? writeFastVLine(x + 5, y, 8, bg) : writeFillRect(x + 5 * size, y, size, 8 * size, bg);
+        endWrite();
+    }
+
+    size_t write(uint8_t c) override
+    {
+        if (c == '\n')
+        {
+            cursor_x = 0;
+            cursor_y += textsize * 8;
+        }
+        else if (c != '\r')
+        {
+            drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+            cursor_x += textsize * 6;
+        }
+        return 1;
+    }
+    using Print::write;
+
+    void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+    void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+    void setTextSize(uint8_t s) { textsize = s > 0 ? s : 1; }
+    void setRotation(uint8_t r)
+    {
+        rotation = r & 3;
+        _width = (rotation & 1) ? HEIGHT : WIDTH;
+        _height = (rotation & 1) ? WIDTH : HEIGHT;
+    }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    const int16_t WIDTH;
+    const int16_t HEIGHT;
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 0xFFFF;
+    uint16_t textbgcolor = 0xFFFF;
+    uint8_t textsize = 1;
+    uint8_t rotation = 0;
+};
+
+/**
+ * @brief A labelled button drawn on an Adafruit_GFX
+ */
+class Adafruit_GFX_Button
+{
+public:
+    void initButtonUL(Adafruit_GFX* gfx, int16_t x1, int16_t y1, uint16_t w, uint16_t h,
+        uint16_t outline, uint16_t fill, uint16_t textcolor, char* label, uint8_t textsize)
+    {
+        _gfx = gfx;
+        _x1 = x1;
+        _y1 = y1;
+        _w = w;
+        _h = h;
+        _outlinecolor = outline;
+        _fillcolor = fill;
+        _textcolor = textcolor;
+        _textsize = textsize;
+        strncpy(_label, label, sizeof(_label) - 1);
+    }
+
+    void drawButton(bool inverted = false)
+    {
+        _gfx->fillRect(_x1, _y1, _w, _h, inverted ? _textcolor : _fillcolor);
+        _gfx->drawRect(_x1, _y1, _w, _h, _outlinecolor);
+        _gfx->setCursor(_x1 + _w / 2 - strlen(_label) * 3 * _textsize, _y1 + _h / 2 - 4 * _textsize);
+        _gfx->setTextColor(inverted ? _fillcolor : _textcolor);
+        _gfx->setTextSize(_textsize);
+        _gfx->print(_label);
+    }
+
+    bool contains(int16_t x, int16_t y)
+    {
+        return x >= _x1 && x < _x1 + _w && y >= _y1 && y < _y1 + _h;
+    }
+
+private:
+    Adafruit_GFX* _gfx = nullptr;
+    int16_t _x1 = 0;
+    int16_t _y1 = 0;
+    uint16_t _w = 0;
+    uint16_t _h = 0;
+    uint16_t _outlinecolor = 0;
+    uint16_t _fillcolor = 0;
+    uint16_t _textcolor = 0;
+    uint8_t _textsize = 1;
+    char _label[10] = {};
+};
+
+#endif // _HOST_ADAFRUIT_GFX_H
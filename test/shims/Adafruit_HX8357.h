@@ -0,0 +1,32 @@
+#ifndef _HOST_ADAFRUIT_HX8357_H
+#define _HOST_ADAFRUIT_HX8357_H
+
+#include <Adafruit_SPITFT.h>
+
+#define HX8357_TFTWIDTH 320
+#define HX8357_TFTHEIGHT 480
+
+#define HX8357_BLACK 0x0000
+#define HX8357_BLUE 0x001F
+#define HX8357_RED 0xF800
+#define HX8357_GREEN 0x07E0
+#define HX8357_CYAN 0x07FF
+#define HX8357_MAGENTA 0xF81F
+#define HX8357_YELLOW 0xFFE0
+#define HX8357_WHITE 0xFFFF
+
+/**
+ * @brief Adafruit_HX8357 for the host tests, counting the bytes each window costs
+ * @remarks A window is the column and row address commands with their 4 byte arguments and the
+ *      memory write command, 11 bytes, as the library sends them.
+ */
+class Adafruit_HX8357 : public Adafruit_SPITFT
+{
+public:
+    Adafruit_HX8357(int8_t cs, int8_t dc, int8_t rst = -1) : Adafruit_SPITFT(HX8357_TFTWIDTH, HX8357_TFTHEIGHT) {}
+
+    void begin(uint32_t freq = 0) {}
+    virtual void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) { streamed += 11; }
+};
+
+#endif // _HOST_ADAFRUIT_HX8357_H
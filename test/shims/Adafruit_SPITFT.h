@@ -0,0 +1,69 @@
+#ifndef _HOST_ADAFRUIT_SPITFT_H
+#define _HOST_ADAFRUIT_SPITFT_H
+
+#include <Adafruit_GFX.h>
+
+/**
+ * @brief Adafruit_SPITFT for the host tests, with the library's clipping and window addressing
+ * @remarks Every primitive clips to the screen, addresses one window and streams its pixels,
+ *      as on the device; nothing is sent anywhere, the bytes streamed are only counted.
+ */
+class Adafruit_SPITFT : public Adafruit_GFX
+{
+public:
+    Adafruit_SPITFT(int16_t w, int16_t h) : Adafruit_GFX(w, h) {}
+
+    virtual void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) = 0;
+
+    void writePixels(uint16_t* colors, uint32_t len, bool block = true, bool bigEndian = false) { streamed += 2 * len; }
+    void writeColor(uint16_t color, uint32_t len) { streamed += 2 * len; }
+    void dmaWait() {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        if (x >= 0 && x < _width && y >= 0 && y < _height)
+        {
+            setAddrWindow(x, y, 1, 1);
+            streamed += 2;
+        }
+    }
+    void writePixel(int16_t x, int16_t y, uint16_t color) override { drawPixel(x, y, color); }
+
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override
+    {
+        if (w < 0)
+        {
+            x += w + 1;
+            w = -w;
+        }
+        if (h < 0)
+        {
+            y += h + 1;
+            h = -h;
+        }
+        if (x >= _width || y >= _height || x + w <= 0 || y + h <= 0)
+            return;
+        if (x < 0)
+        {
+            w += x;
+            x = 0;
+        }
+        if (y < 0)
+        {
+            h += y;
+            y = 0;
+        }
+        if (x + w > _width)
+            w = _width - x;
+        if (y + h > _height)
+            h = _height - y;
+        setAddrWindow(x, y, w, h);
+        writeColor(color, (uint32_t)w * h);
+    }
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override { writeFillRect(x, y, 1, h, color); }
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override { writeFillRect(x, y, w, 1, color); }
+
+    uint32_t streamed = 0;  // bytes sent to the screen, commands and pixels, host only
+};
+
+#endif // _HOST_ADAFRUIT_SPITFT_H
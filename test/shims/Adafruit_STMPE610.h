@@ -0,0 +1,72 @@
+#ifndef _HOST_ADAFRUIT_STMPE610_H
+#define _HOST_ADAFRUIT_STMPE610_H
+
+#include <Arduino.h>
+
+#define STMPE_TSC_CTRL 0x40
+#define STMPE_INT_CTRL 0x09
+#define STMPE_INT_CTRL_POL_LOW 0x00
+#define STMPE_INT_CTRL_EDGE 0x02
+#define STMPE_INT_CTRL_ENABLE 0x01
+#define STMPE_INT_EN 0x0A
+#define STMPE_INT_EN_TOUCHDET 0x01
+#define STMPE_INT_EN_FIFOTH 0x02
+#define STMPE_INT_STA 0x0B
+#define STMPE_FIFO_TH 0x4A
+#define STMPE_FIFO_STA 0x4B
+#define STMPE_FIFO_STA_RESET 0x01
+#define STMPE_FIFO_SIZE 0x4C
+
+class TS_Point
+{
+public:
+    TS_Point() : x(0), y(0), z(0) {}
+    TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+    bool operator==(TS_Point p) { return p.x == x && p.y == y && p.z == z; }
+    bool operator!=(TS_Point p) { return !(*this == p); }
+    int16_t x, y, z;
+};
+
+/**
+ * @brief The touch screen controller for the host tests, with a FIFO the test pushes points into
+ */
+class Adafruit_STMPE610
+{
+public:
+    Adafruit_STMPE610(uint8_t cs) {}
+    Adafruit_STMPE610() {}
+
+    boolean begin(uint8_t i2caddr = 0x41) { return true; }
+    boolean touched() { return !fifo.empty(); }
+    uint8_t bufferSize() { return (uint8_t)fifo.size(); }
+    boolean bufferEmpty() { return fifo.empty(); }
+    TS_Point getPoint()
+    {
+        if (fifo.empty())
+            return TS_Point();
+        TS_Point p = fifo.front();
+        fifo.pop_front();
+        return p;
+    }
+    void readData(uint16_t* x, uint16_t* y, uint8_t* z)
+    {
+        TS_Point p = getPoint();
+        *x = p.x;
+        *y = p.y;
+        *z = p.z;
+    }
+    void writeRegister8(uint8_t reg, uint8_t val)
+    {
+        if (reg == STMPE_FIFO_STA && (val & STMPE_FIFO_STA_RESET))
+            fifo.clear();
+        registers[reg] = val;
+    }
+    uint8_t readRegister8(uint8_t reg) { return reg == STMPE_FIFO_SIZE ? bufferSize() : registers[reg]; }
+
+    std::deque<TS_Point> fifo;      // the raw points not yet read, host only
+
+private:
+    uint8_t registers[256] = {};
+};
+
+#endif // _HOST_ADAFRUIT_STMPE610_H
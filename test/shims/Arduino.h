@@ -0,0 +1,247 @@
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief The Arduino core and FreeRTOS, as far as the modules under test use them, for the host tests
+ * @remarks Time is simulated: it only moves when a test, a delay or a task wait moves it,
+ *      so every run is the same. Tasks are never started, the tests call the loops themselves.
+ *      Queues hold copies, as FreeRTOS does, and the critical sections are no-ops.
+ */
+namespace Host
+{
+    inline uint64_t usec = 0;           // the simulated time
+    inline uint8_t pins[64];            // the level last written to each pin
+    inline uint8_t pinModes[64];        // the mode of each pin
+    inline uint32_t seed = 1;           // the random() state, so runs repeat
+    inline void (*pinWritten)(uint8_t pin, uint8_t level) = nullptr;   // a simulated device watching the pins
+
+    /**
+     * @brief Move the simulated time on
+     */
+    inline void Advance(uint64_t us) { usec += us; }
+};
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define IRAM_ATTR
+#define PROGMEM
+#define PGM_P const char*
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*)(s))
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+using std::min;
+using std::max;
+using std::abs;
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+#define bitRead(v, bit) (((v) >> (bit)) & 0x01)
+#define bitSet(v, bit) ((v) |= (1UL << (bit)))
+#define bitClear(v, bit) ((v) &= ~(1UL << (bit)))
+#define bitWrite(v, bit, b) ((b) ? bitSet(v, bit) : bitClear(v, bit))
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+inline unsigned long millis() { return (unsigned long)(Host::usec / 1000); }
+inline unsigned long micros() { return (unsigned long)(uint32_t)Host::usec; }
+inline void delay(uint32_t ms) { Host::Advance((uint64_t)ms * 1000); }
+inline void delayMicroseconds(uint32_t us) { Host::Advance(us); }
+inline void yield() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) { Host::pinModes[pin] = mode; if (mode == INPUT_PULLUP) Host::pins[pin] = HIGH; }
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+    Host::pins[pin] = level;
+    if (Host::pinWritten != nullptr)
+        Host::pinWritten(pin, level);
+}
+inline int digitalRead(uint8_t pin) { return Host::pins[pin]; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
+
+inline long random(long howbig)
+{
+    // a fixed LCG rather than rand(), the same on every host
+    Host::seed = Host::seed * 1103515245 + 12345;
+    return howbig > 0 ? (long)((Host::seed >> 8) % (uint32_t)howbig) : 0;
+}
+inline long random(long howsmall, long howbig) { return howsmall + random(howbig - howsmall); }
+inline void randomSeed(unsigned long s) { Host::seed = s; }
+
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+inline bool setCpuFrequencyMhz(uint32_t) { return true; }
+
+/**
+ * @brief The ESP object, without a cycle counter: the host's cycles are not the device's
+ */
+class EspClass
+{
+public:
+    uint32_t getCycleCount() { return 0; }
+    uint32_t getFreeHeap() { return 0; }
+};
+
+inline EspClass ESP;
+
+/**
+ * @brief The Print base of the Arduino streams and Adafruit_GFX
+ */
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            write(buf[i]);
+        return len;
+    }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const __FlashStringHelper* s) { return print((const char*)s); }
+    size_t print(int v) { char buf[12]; snprintf(buf, sizeof(buf), "%d", v); return print(buf); }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+    size_t println(const __FlashStringHelper* s) { return println((const char*)s); }
+    size_t printf(const char* format, ...)
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return len > 0 ? print(buf) : 0;
+    }
+};
+
+/**
+ * @brief Serial, written to stdout, with no host commands waiting
+ */
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+};
+
+inline HardwareSerial Serial;
+
+// FreeRTOS
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR()
+
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+inline void portENTER_CRITICAL(portMUX_TYPE*) {}
+inline void portEXIT_CRITICAL(portMUX_TYPE*) {}
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE*) {}
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE*) {}
+
+/**
+ * @brief A FreeRTOS queue, holding copies of its items
+ */
+struct QueueDefinition
+{
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+typedef QueueDefinition* QueueHandle_t;
+typedef QueueDefinition* SemaphoreHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) { return new QueueDefinition { length, itemSize, {} }; }
+inline void vQueueDelete(QueueHandle_t q) { delete q; }
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t)
+{
+    if (q->items.size() >= q->length)
+        return pdFALSE;
+    const uint8_t* p = (const uint8_t*)item;
+    q->items.emplace_back(p, p + q->itemSize);
+    return pdTRUE;
+}
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t*) { return xQueueSend(q, item, 0); }
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t)
+{
+    if (q->items.empty())
+        return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+    return pdTRUE;
+}
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) { return q->items.size(); }
+inline BaseType_t xQueueReset(QueueHandle_t q) { q->items.clear(); return pdPASS; }
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xQueueCreate(1, 0); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return xQueueCreate(1, 0); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return (TaskHandle_t)&Host::usec; }
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t* handle, BaseType_t)
+{
+    if (handle != nullptr)
+        *handle = nullptr;
+    return pdPASS;
+}
+inline void vTaskDelete(TaskHandle_t) {}
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+inline void vTaskDelayUntil(TickType_t* wake, TickType_t period)
+{
+    *wake += period;
+    if ((int32_t)(*wake - xTaskGetTickCount()) > 0)
+        delay(*wake - xTaskGetTickCount());
+}
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+
+#endif // _HOST_ARDUINO_H
@@ -0,0 +1,27 @@
+#ifndef _HOST_DIGITALIO_H
+#define _HOST_DIGITALIO_H
+
+#include <Arduino.h>
+
+/**
+ * @brief The DigitalIO library's fast pins, for the host tests, as PsxControllerBitBang uses them
+ * @remarks Each access goes through the Arduino shim, so a simulated device watching the pins sees it
+ */
+template <uint8_t PinNumber>
+class DigitalPin
+{
+public:
+    void config(uint8_t mode, bool level)
+    {
+        pinMode(PinNumber, mode == INPUT && level ? INPUT_PULLUP : mode);
+        if (mode == OUTPUT)
+            write(level);
+    }
+    void high() { write(true); }
+    void low() { write(false); }
+    void write(bool level) { digitalWrite(PinNumber, level ? HIGH : LOW); }
+    bool read() const { return digitalRead(PinNumber) == HIGH; }
+    operator bool() const { return read(); }
+};
+
+#endif // _HOST_DIGITALIO_H
@@ -0,0 +1,179 @@
+#ifndef _HOST_DOMAIN_H
+#define _HOST_DOMAIN_H
+
+#include <Arduino.h>
+
+enum EntityID
+{
+    EntityID_None,
+    EntityID_LeftMotor,
+    EntityID_RightMotor,
+    EntityID_RearMotor,
+    EntityID_Head,
+    EntityID_NavLights,
+};
+
+inline EntityID& operator++(EntityID& id) { id = (EntityID)(id + 1); return id; }
+inline EntityID operator++(EntityID& id, int) { EntityID old = id; ++id; return old; }
+
+enum PropertyID
+{
+    PropertyID_None,
+    PropertyID_Goal,
+    PropertyID_RPM,
+    PropertyID_Power,
+    PropertyID_Position,
+    PropertyID_Animation,
+    PropertyID_ControlMode,
+    PropertyID_Count,
+};
+
+inline PropertyID& operator++(PropertyID& id) { id = (PropertyID)(id + 1); return id; }
+inline PropertyID operator++(PropertyID& id, int) { PropertyID old = id; ++id; return old; }
+
+/**
+ * @brief A Property of an Entity, for the host tests
+ */
+class Property
+{
+public:
+    int16_t Get() { return value; }
+    void Set(int16_t v)
+    {
+        if (v != value)
+            changed = true;
+        value = v;
+    }
+    PropertyID GetID() { return id; }
+    const char* GetName() { return "Property"; }
+
+    PropertyID id = PropertyID_None;
+    int16_t value = 0;
+    bool changed = false;   // set since the changes were last processed or sent
+    bool echo = false;      // received changed, to be sent back as it is processed
+};
+
+/**
+ * @brief An Entity, for the host tests, with every Property
+ */
+class Entity
+{
+public:
+    Entity(EntityID id, const char* name) : id(id), name(name)
+    {
+        for (PropertyID p = PropertyID_None; p < PropertyID_Count; p++)
+            properties[p].id = p;
+    }
+    EntityID GetID() { return id; }
+    const char* GetName() { return name; }
+    Property* GetProperty(PropertyID p) { return p < PropertyID_Count ? &properties[p] : nullptr; }
+
+private:
+    EntityID id;
+    const char* name;
+    Property properties[PropertyID_Count];
+};
+
+typedef void (*chg_cb)(Entity* pe, Property* pp);
+
+/**
+ * @brief The Domain, for the host tests, sending one message per Property changed
+ * @remarks Set sends a message for each value that changes, as the library does over ESP-NOW;
+ *      the messages are counted, and delivered straight to a Domain linked as the peer.
+ *      Every value delivered is reported by the peer's ProcessChanges, and one that changed
+ *      the peer's copy is sent back once as it is reported, the ping-pong of the library
+ *      that settles once both sides hold the same value.
+ */
+class Domain
+{
+public:
+    Domain(bool isController, Entity** entities) : entities(entities) {}
+
+    void Init(uint8_t* peerAddress) {}
+
+    Entity* GetEntity(EntityID id)
+    {
+        for (Entity** pe = entities; *pe != nullptr; pe++)
+        {
+            if ((*pe)->GetID() == id)
+                return *pe;
+        }
+        return nullptr;
+    }
+
+    Property* GetEntityProperty(EntityID e, PropertyID p)
+    {
+        Entity* pe = GetEntity(e);
+        return pe != nullptr ? pe->GetProperty(p) : nullptr;
+    }
+
+    int16_t GetEntityPropertyValue(EntityID e, PropertyID p)
+    {
+        Property* pp = GetEntityProperty(e, p);
+        return pp != nullptr ? pp->Get() : 0;
+    }
+
+    void SetEntityPropertyValue(EntityID e, PropertyID p, int16_t v)
+    {
+        Property* pp = GetEntityProperty(e, p);
+        if (pp == nullptr || pp->Get() == v)
+            return;
+        // our own change is sent, not reported back to us
+        pp->Set(v);
+        pp->changed = false;
+        Send(e, p, v);
+    }
+
+    void ProcessChanges(chg_cb func)
+    {
+        for (Entity** pe = entities; *pe != nullptr; pe++)
+        {
+            for (PropertyID p = PropertyID_None; p < PropertyID_Count; p++)
+            {
+                Property* pp = (*pe)->GetProperty(p);
+                if (!pp->changed)
+                    continue;
+                pp->changed = false;
+                (*func)(*pe, pp);
+                if (pp->echo)
+                {
+                    pp->echo = false;
+                    Send((*pe)->GetID(), p, pp->Get());
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Link the Domain at the other end of the radio, host only
+     */
+    void Link(Domain* other) { peer = other; }
+
+    uint32_t sent = 0;          // messages sent, host only
+    uint32_t received = 0;      // messages received, host only
+
+private:
+    void Send(EntityID e, PropertyID p, int16_t v)
+    {
+        sent++;
+        if (peer != nullptr)
+            peer->Arrive(e, p, v);
+    }
+
+    void Arrive(EntityID e, PropertyID p, int16_t v)
+    {
+        received++;
+        Property* pp = GetEntityProperty(e, p);
+        if (pp == nullptr)
+            return;
+        if (pp->Get() != v)
+            pp->echo = true;
+        pp->Set(v);
+        pp->changed = true;
+    }
+
+    Entity** entities;
+    Domain* peer = nullptr;
+};
+
+#endif // _HOST_DOMAIN_H
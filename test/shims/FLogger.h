@@ -0,0 +1,52 @@
+#ifndef _HOST_FLOGGER_H
+#define _HOST_FLOGGER_H
+
+#include <Arduino.h>
+
+#define FLOG_NONE 0
+#define FLOG_FATAL 1
+#define FLOG_ERROR 2
+#define FLOG_WARNING 3
+#define FLOG_INFO 4
+#define FLOG_DEBUG 5
+
+/**
+ * @brief FLogger for the host tests, printing to stdout
+ * @remarks Errors are always printed, the rest only at the level set, FLOG_ERROR by default
+ *      so the test output stays readable.
+ */
+namespace FLogger
+{
+    typedef int (*printer)(const char* s);
+
+    inline int level = FLOG_ERROR;
+    inline printer print = nullptr;
+
+    inline void setLogLevel(int l) { level = l; }
+    inline void setPrinter(printer p) { print = p; }
+
+    inline void log(int l, const char* tag, const char* format, ...)
+    {
+        if (l > level)
+            return;
+        char buf[256];
+        int n = snprintf(buf, sizeof(buf), "%s ", tag);
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buf + n, sizeof(buf) - n, format, args);
+        va_end(args);
+        if (print != nullptr)
+            print(buf);
+        else
+            printf("%s\n", buf);
+    }
+};
+
+#define flogf(...) FLogger::log(FLOG_FATAL, "F", __VA_ARGS__)
+#define floge(...) FLogger::log(FLOG_ERROR, "E", __VA_ARGS__)
+#define flogw(...) FLogger::log(FLOG_WARNING, "W", __VA_ARGS__)
+#define flogi(...) FLogger::log(FLOG_INFO, "I", __VA_ARGS__)
+#define flogd(...) FLogger::log(FLOG_DEBUG, "D", __VA_ARGS__)
+#define flogv(...) FLogger::log(FLOG_DEBUG, "V", __VA_ARGS__)
+
+#endif // _HOST_FLOGGER_H
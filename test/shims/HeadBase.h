@@ -0,0 +1,12 @@
+#ifndef _HOST_HEADBASE_H
+#define _HOST_HEADBASE_H
+
+#include "Domain.h"
+
+class HeadBase : public Entity
+{
+public:
+    HeadBase(EntityID id, const char* name) : Entity(id, name) {}
+};
+
+#endif // _HOST_HEADBASE_H
@@ -0,0 +1,12 @@
+#ifndef _HOST_MOTORBASE_H
+#define _HOST_MOTORBASE_H
+
+#include "Domain.h"
+
+class MotorBase : public Entity
+{
+public:
+    MotorBase(EntityID id, const char* name) : Entity(id, name) {}
+};
+
+#endif // _HOST_MOTORBASE_H
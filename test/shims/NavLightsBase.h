@@ -0,0 +1,20 @@
+#ifndef _HOST_NAVLIGHTSBASE_H
+#define _HOST_NAVLIGHTSBASE_H
+
+#include "Domain.h"
+
+enum Animations
+{
+    Animation_Off,
+    Animation_Fwd,
+    Animation_Green,
+    Animation_Cylon,
+};
+
+class NavLightsBase : public Entity
+{
+public:
+    NavLightsBase(EntityID id, const char* name) : Entity(id, name) {}
+};
+
+#endif // _HOST_NAVLIGHTSBASE_H
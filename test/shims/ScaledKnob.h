@@ -0,0 +1,55 @@
+#ifndef _HOST_SCALEDKNOB_H
+#define _HOST_SCALEDKNOB_H
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_seesaw
+{
+public:
+    bool begin(uint8_t addr = 0x49) { return true; }
+};
+
+class seesaw_NeoPixel
+{
+public:
+    seesaw_NeoPixel(uint16_t n, int16_t pin, uint16_t type) {}
+    bool begin(uint8_t addr = 0x49) { return true; }
+    void setBrightness(uint8_t b) {}
+};
+
+/**
+ * @brief A rotary encoder knob scaled to a range, for the host tests
+ * @remarks The value and the button are set by the test, host only.
+ */
+class ScaledKnob
+{
+public:
+    enum class Presses
+    {
+        None,
+        Press,
+        Hold,
+        Release,
+    };
+
+    ScaledKnob(int index, int pixel, float minimum, float maximum, float step) : minimum(minimum), maximum(maximum) {}
+
+    void Init(Adafruit_seesaw* ss, seesaw_NeoPixel* pixels, int offset) {}
+    void SetColor(uint8_t r, uint8_t g, uint8_t b) {}
+    Presses Pressed() { return press; }
+    void Sample() {}
+    float GetValue() { return value; }
+    void SetValue(float v) { value = constrain(v, minimum, maximum); }
+
+    Presses press = Presses::None;  // host only
+
+private:
+    float minimum;
+    float maximum;
+    float value = 0;
+};
+
+#endif // _HOST_SCALEDKNOB_H
@@ -0,0 +1,47 @@
+#ifndef _HOST_DRIVER_GPIO_H
+#define _HOST_DRIVER_GPIO_H
+
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef int gpio_num_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE = 1,
+    GPIO_INTR_NEGEDGE = 2,
+    GPIO_INTR_ANYEDGE = 3,
+    GPIO_INTR_LOW_LEVEL = 4,
+    GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+namespace Host
+{
+    inline bool pullups[64];                // the pins with their pullup enabled
+    inline gpio_int_type_t intrTypes[64];   // the interrupt type of each pin
+    inline bool wakeups[64];                // the pins enabled to wake from light sleep
+};
+
+inline esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) { digitalWrite(pin, level ? HIGH : LOW); return ESP_OK; }
+inline esp_err_t gpio_pullup_en(gpio_num_t pin) { Host::pullups[pin] = true; return ESP_OK; }
+inline esp_err_t gpio_pullup_dis(gpio_num_t pin) { Host::pullups[pin] = false; return ESP_OK; }
+inline esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) { Host::intrTypes[pin] = type; return ESP_OK; }
+inline esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type)
+{
+    Host::intrTypes[pin] = type;
+    Host::wakeups[pin] = true;
+    return ESP_OK;
+}
+inline esp_err_t gpio_wakeup_disable(gpio_num_t pin)
+{
+    Host::intrTypes[pin] = GPIO_INTR_DISABLE;
+    Host::wakeups[pin] = false;
+    return ESP_OK;
+}
+
+#endif // _HOST_DRIVER_GPIO_H
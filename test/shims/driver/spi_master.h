@@ -0,0 +1,181 @@
+#ifndef _HOST_DRIVER_SPI_MASTER_H
+#define _HOST_DRIVER_SPI_MASTER_H
+
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+#define ESP_FAIL -1
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+typedef enum { SPI_DMA_DISABLED, SPI_DMA_CH1, SPI_DMA_CH2, SPI_DMA_CH_AUTO = 3 } spi_dma_chan_t;
+
+typedef struct
+{
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+} spi_bus_config_t;
+
+struct spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t* trans);
+
+typedef struct
+{
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    uint16_t duty_cycle_pos;
+    uint16_t cs_ena_pretrans;
+    uint8_t cs_ena_posttrans;
+    int clock_speed_hz;
+    int input_delay_ns;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+typedef struct spi_transaction_t
+{
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;
+    size_t rxlength;
+    void* user;
+    union
+    {
+        const void* tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union
+    {
+        void* rx_buffer;
+        uint8_t rx_data[4];
+    };
+} spi_transaction_t;
+
+#define SPI_TRANS_USE_RXDATA (1 << 2)
+#define SPI_TRANS_USE_TXDATA (1 << 3)
+
+#define SPI_DEVICE_TXBIT_LSBFIRST (1 << 0)
+#define SPI_DEVICE_RXBIT_LSBFIRST (1 << 1)
+#define SPI_DEVICE_BIT_LSBFIRST (SPI_DEVICE_TXBIT_LSBFIRST | SPI_DEVICE_RXBIT_LSBFIRST)
+
+struct spi_device_t
+{
+    spi_device_interface_config_t config;
+    spi_transaction_t* queued;      // the transaction under way in the background
+    uint64_t done;                  // Host::spiUsec it completes
+};
+typedef spi_device_t* spi_device_handle_t;
+
+/**
+ * @brief The SPI master driver for the host tests, handing each transaction to the test
+ * @remarks The test sets spiTransfer to exchange one byte with the simulated device; a transaction
+ *      of several bytes is exchanged a byte at a time, each taking 8 clock periods of simulated time.
+ *      The bus keeps its own time, spiUsec: a polling transaction is waited out by the CPU, moving
+ *      the simulated time along with the bus, while a queued one runs ahead of it in the background,
+ *      exchanged as it is queued, and is only waited for by a get_trans_result before it is done.
+ *      The post_cb is called as the result is taken, rather than from the interrupt at the end.
+ */
+namespace Host
+{
+    typedef uint8_t (*spi_transfer_t)(uint8_t out);
+
+    inline spi_transfer_t spiTransfer = nullptr;    // exchanges one byte with the device
+    inline spi_device_t spiDevice;                  // the one device added
+    inline uint32_t spiTransactions = 0;            // transactions transmitted
+    inline uint64_t spiUsec = 0;                    // the time on the bus, the start of each byte as it is exchanged
+
+    /**
+     * @brief Exchange a transaction on the bus, from now or the end of the one before
+     *
+     * @return uint64_t spiUsec at its end
+     */
+    inline uint64_t SpiExchange(spi_device_handle_t handle, spi_transaction_t* t)
+    {
+        spiTransactions++;
+        spiUsec = max(spiUsec, usec);
+        const uint8_t* tx = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data : (const uint8_t*)t->tx_buffer;
+        uint8_t* rx = (t->flags & SPI_TRANS_USE_RXDATA) ? t->rx_data : (uint8_t*)t->rx_buffer;
+        uint32_t clock = handle->config.clock_speed_hz > 0 ? handle->config.clock_speed_hz : 1000000;
+        for (size_t i = 0; i < t->length / 8; i++)
+        {
+            uint8_t in = spiTransfer != nullptr ? spiTransfer(tx != nullptr ? tx[i] : 0) : 0xFF;
+            if (rx != nullptr)
+                rx[i] = in;
+            spiUsec += 8 * 1000000ULL / clock;
+        }
+        return spiUsec;
+    }
+};
+
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_TIMEOUT 0x107
+
+inline esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config, spi_dma_chan_t dma)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config, spi_device_handle_t* handle)
+{
+    Host::spiDevice.config = *config;
+    *handle = &Host::spiDevice;
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* t)
+{
+    // the driver refuses a polling transaction with one queued
+    if (handle->queued != nullptr)
+        return ESP_ERR_INVALID_STATE;
+    Host::usec = Host::SpiExchange(handle, t);
+    if (handle->config.post_cb != nullptr)
+        handle->config.post_cb(t);
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* t, TickType_t ticks)
+{
+    if (handle->queued != nullptr)
+        return ESP_ERR_TIMEOUT;
+    handle->done = Host::SpiExchange(handle, t);
+    handle->queued = t;
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** t, TickType_t ticks)
+{
+    if (handle->queued == nullptr)
+        return ESP_ERR_TIMEOUT;
+    if (Host::usec < handle->done)
+    {
+        if (ticks == 0)
+            return ESP_ERR_TIMEOUT;
+        // blocked, so the CPU is free, until the transaction is done
+        Host::usec = handle->done;
+    }
+    *t = handle->queued;
+    handle->queued = nullptr;
+    if (handle->config.post_cb != nullptr)
+        handle->config.post_cb(*t);
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* t)
+{
+    return spi_device_polling_transmit(handle, t);
+}
+
+#endif // _HOST_DRIVER_SPI_MASTER_H
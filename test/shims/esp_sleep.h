@@ -0,0 +1,21 @@
+#ifndef _HOST_ESP_SLEEP_H
+#define _HOST_ESP_SLEEP_H
+
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+namespace Host
+{
+    inline uint64_t sleepUsec = 0;          // the timer wakeup of the next light sleep
+};
+
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) { Host::sleepUsec = us; return ESP_OK; }
+inline esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+// a light sleep lasts until the timer, the host has no touches to wake it sooner
+inline esp_err_t esp_light_sleep_start() { Host::Advance(Host::sleepUsec); return ESP_OK; }
+
+#endif // _HOST_ESP_SLEEP_H
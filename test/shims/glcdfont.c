@@ -0,0 +1,7 @@
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+// the classic 5x7 font for the host tests, blank: the tests count the pixels drawn, not their color
+static const unsigned char font[256 * 5] = {};
+
+#endif // FONT5X7_H
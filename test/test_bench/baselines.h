@@ -0,0 +1,35 @@
+#ifndef _BASELINES_H
+#define _BASELINES_H
+
+#include <Arduino.h>
+
+/**
+ * @brief The most work a bench case may do on the host, in all its Bench::eventCount events
+ * @remarks Measured by the counting display of the host build, so they hold on every host.
+ *      They are totals rather than per event, so a fraction of a window or a pixel more is caught.
+ *      The cycles are only measured on the device, against the budgets in Bench.cpp.
+ *      When a change is meant to move a number, update it here along with the change.
+ */
+struct Baseline
+{
+    const char* name;   // the bench case
+    uint32_t pixels;    // pixels written
+    uint32_t windows;   // address windows set, each an SPI transaction
+    uint32_t bytes;     // bytes sent to the screen, commands and pixels
+    uint32_t sets;      // Property values set
+};
+
+const Baseline baselines[] =
+{
+    //  name           pixels  windows    bytes  sets
+    { "stick",              0,      0,        0,    0 },
+    { "button",             0,      0,        0,    0 },
+    { "walk",               0,      0,        0,    0 },
+    { "guidance",           0,      0,        0,  804 },
+    { "text",           42624,    200,    87448,    0 },
+    { "bar",             2304,    144,     6192,    0 },
+    { "echo btn",      600400,    400,  1205200,    0 },
+    { "echo stick",    904200,    400,  1812800,    0 },
+};
+
+#endif // _BASELINES_H
@@ -0,0 +1,11 @@
+// the packed UI images, embedded under the names board_build.embed_files gives them on the device,
+// assets/ui.bin being packed by the pack_assets.py pre: script before the build
+__asm__(
+    ".data\n"
+    ".balign 4\n"
+    ".global _binary_assets_ui_bin_start\n"
+    "_binary_assets_ui_bin_start:\n"
+    ".incbin \"assets/ui.bin\"\n"
+    ".global _binary_assets_ui_bin_end\n"
+    "_binary_assets_ui_bin_end:\n"
+    ".text\n");
@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PSXPad.h"
+#include "Bench.h"
+#include "Assets.h"
+#include "Pad.h"
+#include "Profiles.h"
+#include "Sync.h"
+#include "MotorBase.h"
+#include "HeadBase.h"
+#include "NavLightsBase.h"
+#include "baselines.h"
+
+// the screen, Entities and Domain of main.cpp, which is not part of the host build
+Display tft = Display(TFT_CS, TFT_DC);
+MotorBase LeftMotor = MotorBase(EntityID_LeftMotor, "Left Motor");
+MotorBase RightMotor = MotorBase(EntityID_RightMotor, "Right Motor");
+MotorBase RearMotor = MotorBase(EntityID_RearMotor, "Rear Motor");
+HeadBase HeadX = HeadBase(EntityID_Head, "Head");
+NavLightsBase NavLites = NavLightsBase(EntityID_NavLights, "Nav Lights");
+Entity* entities[6] = { &LeftMotor, &RightMotor, &RearMotor, &HeadX, &NavLites, nullptr };
+Domain VirtualBot = Domain(true, entities);
+uint8_t botMacAddress[] = { 0xA0, 0xB7, 0x65, 0x4A, 0x21, 0x54 };
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief Start up as main does before it runs the benchmarks
+ */
+void Boot()
+{
+    Sync::Init(botMacAddress);
+    tft.begin();
+    tft.setRotation(1);
+    tft.fillScreen(HX8357_BLACK);
+    tft.setTextSize(2);
+    Assets::Init();
+    // the default profiles, not those stored by an earlier run
+    remove("profiles.bin");
+    Profiles::Init();
+    Pad::Init();
+}
+
+void test_budgets()
+{
+    // the streamed bytes are what the Display counts, none are sent outside a window
+    uint32_t streamed = tft.streamed;
+    uint32_t bytes = tft.bytes;
+    // the cycles are not the device's, so only the counting is checked here
+    TEST_ASSERT_TRUE(Bench::Run());
+    TEST_ASSERT_EQUAL_UINT32(tft.streamed - streamed, tft.bytes - bytes);
+}
+
+void test_baselines()
+{
+    char buf[120];
+    for (const Baseline& b : baselines)
+    {
+        Bench::Result r;
+        uint32_t sets = Sync::GetStats().sets;
+        TEST_ASSERT_TRUE_MESSAGE(Bench::Measure(b.name, r), b.name);
+        sets = Sync::GetStats().sets - sets;
+        snprintf(buf, sizeof(buf), "%-10s %7.2f px %5.2f win %8.2f B %5.2f sets per event", b.name,
+            (float)r.pixels / Bench::eventCount, (float)r.windows / Bench::eventCount,
+            (float)r.bytes / Bench::eventCount, (float)sets / Bench::eventCount);
+        TEST_MESSAGE(buf);
+        // a regression is more work than the baseline
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(b.pixels, r.pixels, b.name);
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(b.windows, r.windows, b.name);
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(b.bytes, r.bytes, b.name);
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(b.sets, sets, b.name);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Boot();
+    UNITY_BEGIN();
+    RUN_TEST(test_budgets);
+    RUN_TEST(test_baselines);
+    return UNITY_END();
+}
@@ -0,0 +1,233 @@
+#ifndef _SIMPAD_H
+#define _SIMPAD_H
+
+#include <Arduino.h>
+#include <driver/spi_master.h>
+#include "PSXPad.h"
+
+/**
+ * @brief A simulated DualShock 2 on the host SPI and pin shims
+ * @remarks A packet starts as the attention line falls: the pad answers the 0x01 with 0xFF,
+ *      the command byte with its mode, digital 0x41, analog 0x73, analog with pressures 0x79
+ *      or config 0xF3, and then 0x5A and twice the low nibble of the mode in data bytes.
+ *      Polls (0x42) return the buttons, active low, then the right and left sticks
+ *      and the 12 button pressures as the mode has them. Config mode is entered and left
+ *      with 0x43, and in it 0x44 sets the analog mode, 0x4F the pressures and 0x45 reads the type.
+ *      As on the pad, a command takes effect once attention rises at the end of its packet.
+ *      Bytes come whole from the SPI shim, or a bit at a time from a bit-banged clock:
+ *      the pad puts each bit out as the clock falls and takes the command's in as it rises.
+ *      The time and attention level of every byte are kept for checking the timing.
+ */
+namespace SimPad
+{
+    const uint8_t frameMax = 21;        // the longest packet, a poll with the pressures
+
+    // the pad's state
+    inline bool config = false;
+    inline bool analog = false;
+    inline bool locked = false;
+    inline bool pressures = false;
+    inline uint16_t buttons = 0xFFFF;   // active low, select in bit 0
+    inline uint8_t sticks[4] = { 0x80, 0x80, 0x80, 0x80 };    // RX, RY, LX, LY
+    inline uint8_t pressure[12];        // right, left, up, down, triangle, circle, cross, square, L1, R1, L2, R2
+
+    // the packet under way
+    inline uint8_t index = 0;
+    inline uint8_t command[frameMax];   // bytes received
+    inline uint8_t reply[frameMax];     // bytes to send
+    inline uint8_t replyLen = 3;
+    inline uint64_t starts[frameMax];   // the time each byte started
+    inline uint8_t bit = 0;             // the bit of a bit-banged byte under way
+    inline uint8_t out = 0;             // the byte being sent
+    inline uint8_t in = 0;              // the byte being received
+    inline uint8_t clock = HIGH;        // the clock line, idle high
+
+    // the timing seen
+    inline uint8_t longest = 0;         // bytes in the longest packet
+    inline uint32_t gapMin = 0xFFFFFFFF;    // usec between the end of a byte and the start of the next, on SPI
+    inline bool attentionLost = false;  // a byte was exchanged without attention
+
+    inline uint8_t Mode()
+    {
+        if (config)
+            return 0xF3;
+        return analog ? (pressures ? 0x79 : 0x73) : 0x41;
+    }
+
+    /**
+     * @brief Prepare the reply once the command byte is known
+     */
+    inline void Answer(uint8_t cmd)
+    {
+        uint8_t mode = Mode();
+        memset(reply, 0, sizeof(reply));
+        reply[0] = 0xFF;
+        reply[1] = mode;
+        reply[2] = 0x5A;
+        replyLen = 3 + (mode & 0x0F) * 2;
+        uint8_t* p = reply + 3;
+        if (config)
+        {
+            if (cmd == 0x45)
+            {
+                const uint8_t type[] = { 0x03, 0x02, (uint8_t)(analog ? 0x01 : 0x00), 0x02, 0x01, 0x00 };
+                memcpy(p, type, sizeof(type));
+            }
+            return;
+        }
+        *p++ = (uint8_t)buttons;
+        *p++ = (uint8_t)(buttons >> 8);
+        if (analog)
+        {
+            memcpy(p, sticks, sizeof(sticks));
+            p += sizeof(sticks);
+        }
+        if (pressures)
+            memcpy(p, pressure, sizeof(pressure));
+    }
+
+    /**
+     * @brief Apply the packet just ended
+     */
+    inline void Apply()
+    {
+        if (index < 4)
+            return;
+        switch (command[1])
+        {
+        case 0x43:
+            config = command[3] == 0x01;
+            break;
+        case 0x44:
+            if (config)
+            {
+                analog = command[3] == 0x01;
+                locked = command[4] == 0x03;
+                if (!analog)
+                    pressures = false;
+            }
+            break;
+        case 0x4F:
+            if (config && analog)
+                pressures = (command[3] | command[4] | command[5]) != 0;
+            break;
+        }
+    }
+
+    /**
+     * @brief The time now, on the bus, which runs ahead of the CPU through a queued transaction
+     */
+    inline uint64_t Now()
+    {
+        return max(Host::usec, Host::spiUsec);
+    }
+
+    /**
+     * @brief Start a byte, giving the pad's byte for it
+     */
+    inline uint8_t Begin()
+    {
+        if (Host::pins[PSX_ATT] != LOW)
+        {
+            attentionLost = true;
+            return 0xFF;
+        }
+        if (index >= frameMax)
+            return 0xFF;
+        starts[index] = Now();
+        // the mode goes out before the command it answers is in
+        if (index == 1)
+            return Mode();
+        if (index == 2)
+            return 0x5A;
+        return index < replyLen ? reply[index] : 0xFF;
+    }
+
+    /**
+     * @brief End a byte with the command's byte
+     */
+    inline void End(uint8_t cmd)
+    {
+        if (Host::pins[PSX_ATT] != LOW || index >= frameMax)
+            return;
+        command[index] = cmd;
+        if (index == 1)
+            Answer(cmd);
+        index++;
+    }
+
+    inline void PinWritten(uint8_t pin, uint8_t level)
+    {
+        if (pin == PSX_ATT)
+        {
+            if (level == HIGH && index > 0)
+            {
+                Apply();
+                longest = max(longest, index);
+            }
+            index = 0;
+            bit = 0;
+            // released, the pull-up has the data line
+            Host::pins[PSX_DAT] = HIGH;
+        }
+        else if (pin == PSX_CLK && level != clock)
+        {
+            clock = level;
+            if (Host::pins[PSX_ATT] != LOW)
+                return;
+            if (level == LOW)
+            {
+                if (bit == 0)
+                {
+                    out = Begin();
+                    in = 0;
+                }
+                Host::pins[PSX_DAT] = bitRead(out, bit);
+            }
+            else
+            {
+                if (Host::pins[PSX_CMD])
+                    bitSet(in, bit);
+                if (++bit == 8)
+                {
+                    bit = 0;
+                    End(in);
+                }
+            }
+        }
+    }
+
+    inline uint8_t Transfer(uint8_t cmd)
+    {
+        uint8_t reply = Begin();
+        if (index > 0 && index < frameMax)
+        {
+            // each byte is 8 clocks of the device's rate
+            uint32_t byteUsec = 8 * 1000000UL / Host::spiDevice.config.clock_speed_hz;
+            gapMin = min(gapMin, (uint32_t)(starts[index] - starts[index - 1] - byteUsec));
+        }
+        End(cmd);
+        return reply;
+    }
+
+    /**
+     * @brief Power the pad up in digital mode, attached to the shims
+     */
+    inline void Connect()
+    {
+        config = analog = locked = pressures = false;
+        buttons = 0xFFFF;
+        memset(sticks, 0x80, sizeof(sticks));
+        memset(pressure, 0, sizeof(pressure));
+        index = 0;
+        bit = 0;
+        clock = HIGH;
+        longest = 0;
+        gapMin = 0xFFFFFFFF;
+        attentionLost = false;
+        Host::pinWritten = &PinWritten;
+        Host::spiTransfer = &Transfer;
+    }
+};
+
+#endif // _SIMPAD_H
@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <PsxControllerBitBang.h>
+#include "PSXPad.h"
+#include "PsxSpi.h"
+#include "SimPad.h"
+
+// as Pad has it, without an ACK line
+PsxControllerSpi psx(SPI2_HOST, PSX_ATT, PSX_CMD, PSX_DAT, PSX_CLK);
+// the driver it replaces, on the same pins, for comparison
+PsxControllerBitBang<PSX_ATT, PSX_CMD, PSX_DAT, PSX_CLK> bitBang;
+
+const uint16_t reads = 100;             // reads timed of each driver
+const uint16_t tickMsec = 20;           // the active control tick
+
+void setUp()
+{
+    SimPad::Connect();
+}
+
+void tearDown()
+{
+}
+
+/**
+ * @brief Put the pad in analog mode with the pressures, as Pad::EnableAnalog does
+ */
+template <typename T>
+void EnableAnalog(T& pad)
+{
+    TEST_ASSERT_TRUE(pad.begin());
+    TEST_ASSERT_TRUE(pad.enterConfigMode());
+    TEST_ASSERT_TRUE(pad.enableAnalogSticks(true, true));
+    TEST_ASSERT_TRUE(pad.enableAnalogButtons());
+    TEST_ASSERT_TRUE(pad.exitConfigMode());
+}
+
+void test_begin()
+{
+    TEST_ASSERT_TRUE(psx.begin());
+    // mode 3, LSB first, at the pad's clock, attention released
+    TEST_ASSERT_EQUAL(3, Host::spiDevice.config.mode);
+    TEST_ASSERT_EQUAL(SPI_DEVICE_BIT_LSBFIRST, Host::spiDevice.config.flags & SPI_DEVICE_BIT_LSBFIRST);
+    TEST_ASSERT_EQUAL(PsxControllerSpi::clockHz, Host::spiDevice.config.clock_speed_hz);
+    TEST_ASSERT_EQUAL(HIGH, Host::pins[PSX_ATT]);
+    TEST_ASSERT_FALSE(SimPad::attentionLost);
+    // nothing to take without a poll started
+    TEST_ASSERT_FALSE(psx.FinishRead());
+}
+
+void test_digital()
+{
+    TEST_ASSERT_TRUE(psx.begin());
+    SimPad::buttons = (uint16_t)~(PSB_CROSS | PSB_START);
+    TEST_ASSERT_TRUE(psx.StartRead());
+    TEST_ASSERT_TRUE(psx.FinishRead());
+    TEST_ASSERT_TRUE(psx.buttonPressed(PSB_CROSS));
+    TEST_ASSERT_TRUE(psx.buttonPressed(PSB_START));
+    TEST_ASSERT_FALSE(psx.buttonPressed(PSB_CIRCLE));
+    TEST_ASSERT_FALSE(psx.getAnalogSticksValid());
+    // the whole frame is clocked, the digital pad's 5 bytes and then the floating data line
+    TEST_ASSERT_EQUAL(PsxControllerSpi::frameSize, SimPad::longest);
+}
+
+void test_analog()
+{
+    EnableAnalog(psx);
+    TEST_ASSERT_EQUAL_HEX8(0x79, SimPad::Mode());
+    TEST_ASSERT_TRUE(SimPad::locked);
+
+    const uint8_t sticks[] = { 0x10, 0x20, 0xE0, 0xF0 };
+    memcpy(SimPad::sticks, sticks, sizeof(sticks));
+    SimPad::buttons = (uint16_t)~PSB_CROSS;
+    SimPad::pressure[PSAB_CROSS] = 0xC0;
+    SimPad::pressure[PSAB_R2] = 0x40;
+    SimPad::longest = 0;
+    TEST_ASSERT_TRUE(psx.StartRead());
+    TEST_ASSERT_TRUE(psx.FinishRead());
+    TEST_ASSERT_EQUAL(SimPad::frameMax, SimPad::longest);
+    TEST_ASSERT_TRUE(psx.getAnalogSticksValid());
+    byte x, y;
+    psx.getLeftAnalog(x, y);
+    TEST_ASSERT_EQUAL_HEX8(0xE0, x);
+    TEST_ASSERT_EQUAL_HEX8(0xF0, y);
+    psx.getRightAnalog(x, y);
+    TEST_ASSERT_EQUAL_HEX8(0x10, x);
+    TEST_ASSERT_EQUAL_HEX8(0x20, y);
+    TEST_ASSERT_TRUE(psx.getAnalogButtonDataValid());
+    TEST_ASSERT_EQUAL_HEX8(0xC0, psx.getAnalogButton(PSAB_CROSS));
+    TEST_ASSERT_EQUAL_HEX8(0x40, psx.getAnalogButton(PSAB_R2));
+    TEST_ASSERT_EQUAL_HEX8(0x00, psx.getAnalogButton(PSAB_SQUARE));
+    TEST_ASSERT_TRUE(psx.buttonPressed(PSB_CROSS));
+}
+
+void test_background()
+{
+    EnableAnalog(psx);
+    // the frame goes out in one transaction, the bytes back to back
+    uint32_t transactions = Host::spiTransactions;
+    SimPad::gapMin = 0xFFFFFFFF;
+    TEST_ASSERT_TRUE(psx.StartRead());
+    TEST_ASSERT_EQUAL_UINT32(transactions + 1, Host::spiTransactions);
+    TEST_ASSERT_EQUAL_UINT32(0, SimPad::gapMin);
+    // attention held through the frame, and only released at its end
+    TEST_ASSERT_FALSE(SimPad::attentionLost);
+    TEST_ASSERT_EQUAL(LOW, Host::pins[PSX_ATT]);
+    TEST_ASSERT_FALSE(psx.StartRead());
+    Host::Advance(tickMsec * 1000);
+    TEST_ASSERT_TRUE(psx.FinishRead());
+    TEST_ASSERT_EQUAL(HIGH, Host::pins[PSX_ATT]);
+    // the config exchanges a byte at a time keep the base class's gap
+    SimPad::gapMin = 0xFFFFFFFF;
+    TEST_ASSERT_TRUE(psx.enterConfigMode());
+    TEST_ASSERT_TRUE(psx.exitConfigMode());
+    TEST_ASSERT_GREATER_OR_EQUAL(INTER_CMD_BYTE_DELAY, SimPad::gapMin);
+}
+
+void test_cpu_per_read()
+{
+    // the time the control task spends in each read, once per tick
+    EnableAnalog(bitBang);
+    uint64_t bitBangUsec = 0;
+    for (int i = 0; i < reads; i++)
+    {
+        Host::Advance(tickMsec * 1000);
+        uint64_t start = Host::usec;
+        TEST_ASSERT_TRUE(bitBang.read());
+        bitBangUsec += Host::usec - start;
+    }
+    TEST_ASSERT_TRUE(bitBang.getAnalogButtonDataValid());
+
+    SimPad::Connect();
+    EnableAnalog(psx);
+    uint64_t spiUsec = 0;
+    TEST_ASSERT_TRUE(psx.StartRead());
+    for (int i = 0; i < reads; i++)
+    {
+        Host::Advance(tickMsec * 1000);
+        uint64_t start = Host::usec;
+        TEST_ASSERT_TRUE(psx.FinishRead());
+        TEST_ASSERT_TRUE(psx.StartRead());
+        spiUsec += Host::usec - start;
+    }
+    TEST_ASSERT_TRUE(psx.FinishRead());
+    TEST_ASSERT_TRUE(psx.getAnalogButtonDataValid());
+
+    char buf[80];
+    snprintf(buf, sizeof(buf), "CPU per read: bit-bang %.0f us, SPI %.0f us",
+        (float)bitBangUsec / reads, (float)spiUsec / reads);
+    TEST_MESSAGE(buf);
+    // only the attention settle time is spent, the frame and its parsing take none
+    TEST_ASSERT_LESS_OR_EQUAL(reads * PsxControllerSpi::attentionUsec, spiUsec);
+    TEST_ASSERT_LESS_THAN(bitBangUsec / 20, spiUsec);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin);
+    RUN_TEST(test_digital);
+    RUN_TEST(test_analog);
+    RUN_TEST(test_background);
+    RUN_TEST(test_cpu_per_read);
+    return UNITY_END();
+}
@@ -0,0 +1,335 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PSXPad.h"
+#include "Sync.h"
+#include "State.h"
+#include "MotorBase.h"
+#include "HeadBase.h"
+#include "NavLightsBase.h"
+#include "SimPeer.h"
+
+// the Entities and Domain of main.cpp, which is not part of the host build
+MotorBase LeftMotor = MotorBase(EntityID_LeftMotor, "Left Motor");
+MotorBase RightMotor = MotorBase(EntityID_RightMotor, "Right Motor");
+MotorBase RearMotor = MotorBase(EntityID_RearMotor, "Rear Motor");
+HeadBase HeadX = HeadBase(EntityID_Head, "Head");
+NavLightsBase NavLites = NavLightsBase(EntityID_NavLights, "Nav Lights");
+Entity* entities[6] = { &LeftMotor, &RightMotor, &RearMotor, &HeadX, &NavLites, nullptr };
+Domain VirtualBot = Domain(true, entities);
+uint8_t botMacAddress[] = { 0xA0, 0xB7, 0x65, 0x4A, 0x21, 0x54 };
+
+// the robot's Domain, linked to ours for the loopback
+MotorBase RobotLeft = MotorBase(EntityID_LeftMotor, "Left Motor");
+MotorBase RobotRight = MotorBase(EntityID_RightMotor, "Right Motor");
+MotorBase RobotRear = MotorBase(EntityID_RearMotor, "Rear Motor");
+HeadBase RobotHead = HeadBase(EntityID_Head, "Head");
+NavLightsBase RobotLites = NavLightsBase(EntityID_NavLights, "Nav Lights");
+Entity* robotEntities[6] = { &RobotLeft, &RobotRight, &RobotRear, &RobotHead, &RobotLites, nullptr };
+Domain RobotBot = Domain(false, robotEntities);
+
+const uint16_t tickMsec = 20;           // the active control tick
+const uint16_t sessionTicks = 500;      // 10 seconds of driving
+
+/**
+ * @brief The traffic of a driving session
+ */
+struct Session
+{
+    uint32_t sets;          // Property values set by the control ticks
+    uint32_t updates;       // Property values sent
+    uint32_t messages;      // Domain messages sent
+    uint32_t frames;        // Sync frames sent
+    uint32_t bytes;         // Sync frame bytes sent
+};
+
+void Apply(EntityID entity, PropertyID property, int16_t v)
+{
+}
+
+/**
+ * @brief Drive a scripted stick session through Sync, one control tick at a time
+ * @remarks The stick sweeps round, mixed to the three wheel goals as Drive does,
+ *      with the nav lights animation changed every 2 seconds.
+ */
+Session Drive(bool frames)
+{
+    Sync::UseFrames(frames);
+    // until the robot has answered the offer
+    for (int tick = 0; tick < 2 * Sync::clockInterval / tickMsec && Sync::Frames() != frames; tick++)
+    {
+        Host::Advance(tickMsec * 1000);
+        Sync::Flush();
+        Sync::Poll(&Apply);
+    }
+    const Sync::Stats before = Sync::GetStats();
+    uint32_t messages = VirtualBot.sent;
+    for (int tick = 0; tick < sessionTicks; tick++)
+    {
+        Host::Advance(tickMsec * 1000);
+        float t = tick * tickMsec / 1000.0f;
+        int16_t x = (int16_t)(100 * sinf(TWO_PI * 0.5f * t));
+        int16_t y = (int16_t)(100 * cosf(TWO_PI * 0.3f * t));
+        Sync::Set(EntityID_LeftMotor, PropertyID_Goal, constrain(y + x / 2, -100, 100));
+        Sync::Set(EntityID_RightMotor, PropertyID_Goal, constrain(y - x / 2, -100, 100));
+        Sync::Set(EntityID_RearMotor, PropertyID_Goal, x);
+        if (tick % 100 == 0)
+            Sync::Set(EntityID_NavLights, PropertyID_Animation, (tick / 100) % 4);
+        Sync::Flush();
+        Sync::Poll(&Apply);
+    }
+    const Sync::Stats& after = Sync::GetStats();
+    return { after.sets - before.sets, after.updates - before.updates, VirtualBot.sent - messages,
+        after.frames - before.frames, after.bytes - before.bytes };
+}
+
+int16_t rpm = 0;                        // the last left motor RPM passed on by Sync
+
+/**
+ * @brief Pass on a change from the robot, as main's ReceiveChange does
+ */
+void Received(EntityID entity, PropertyID property, int16_t v)
+{
+    if (Sync::Receive(entity, property, v) && entity == EntityID_LeftMotor && property == PropertyID_RPM)
+        rpm = v;
+}
+
+void ControllerChange(Entity* pe, Property* pp)
+{
+    Received(pe->GetID(), pp->GetID(), pp->Get());
+}
+
+/**
+ * @brief The robot's motors, reaching their goals at once
+ */
+void RobotChange(Entity* pe, Property* pp)
+{
+    if (pp->GetID() == PropertyID_Goal)
+        RobotBot.SetEntityPropertyValue(pe->GetID(), PropertyID_RPM, pp->Get());
+}
+
+// the left motor page, whose goal the robot has no need to send back
+const Subscription motorSubs[] =
+{
+    { EntityID_LeftMotor, PropertyID_Goal, 0 },
+    { EntityID_LeftMotor, PropertyID_RPM, 0 },
+};
+
+const uint8_t setpoints = 20;           // goal changes in the loopback
+const uint8_t settleTicks = 10;         // control ticks for each to settle
+
+/**
+ * @brief The traffic of the setpoint changes
+ */
+struct Loopback
+{
+    uint32_t sent;          // Domain messages or Sync frames sent, both ways
+    uint32_t echoes;        // changes to the controller's own values received
+    int16_t goal;           // the last goal set
+};
+
+/**
+ * @brief Tick the controller and the robot
+ */
+void Tick()
+{
+    Host::Advance(tickMsec * 1000);
+    Sync::Flush();
+    Sync::Poll(&Received);
+    VirtualBot.ProcessChanges(&ControllerChange);
+    RobotBot.ProcessChanges(&RobotChange);
+}
+
+/**
+ * @brief Step the left motor goal, ticking the controller and robot until each change settles
+ */
+Loopback Setpoints(bool frames)
+{
+    Sync::UseFrames(frames);
+    // until the link has changed over and caught up
+    for (int tick = 0; tick < 2 * Sync::clockInterval / tickMsec; tick++)
+        Tick();
+    const Sync::Stats& stats = Sync::GetStats();
+    uint32_t sent = frames ? stats.frames + SimPeer::Frames() : VirtualBot.sent + RobotBot.sent;
+    uint32_t echoes = stats.echoes;
+    int16_t goal = 0;
+    for (int i = 0; i < setpoints; i++)
+    {
+        goal = (i % 2 ? 1 : -1) * (10 + i);
+        Sync::Set(EntityID_LeftMotor, PropertyID_Goal, goal);
+        for (int tick = 0; tick < settleTicks; tick++)
+            Tick();
+    }
+    sent = (frames ? stats.frames + SimPeer::Frames() : VirtualBot.sent + RobotBot.sent) - sent;
+    return { sent, stats.echoes - echoes, goal };
+}
+
+const uint16_t clockSeconds = 300;      // long enough for the drift's fit to hold only this drift
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_varint_zigzag()
+{
+    const int16_t values[] = { 0, 1, -1, 63, -64, 64, 127, 128, -129, 8191, -8192, 32767, -32768 };
+    for (int16_t v : values)
+    {
+        uint8_t buf[4];
+        uint8_t* p = buf;
+        Sync::PutVarint(p, Sync::ZigZag(v));
+        const uint8_t* q = buf;
+        uint16_t u;
+        TEST_ASSERT_TRUE(Sync::GetVarint(q, p, u));
+        TEST_ASSERT_EQUAL_INT16(v, Sync::UnZigZag(u));
+        // small values take a single byte
+        if (v >= -64 && v <= 63)
+            TEST_ASSERT_EQUAL(1, p - buf);
+    }
+}
+
+void test_frames_offered()
+{
+    Sync::Init(botMacAddress);
+    // the Domain's messages until the robot answers a clock exchange
+    Sync::UseFrames(true);
+    TEST_ASSERT_FALSE(Sync::Frames());
+    for (int tick = 0; tick < 2 * Sync::clockInterval / tickMsec && !Sync::Frames(); tick++)
+    {
+        Host::Advance(tickMsec * 1000);
+        Sync::Set(EntityID_LeftMotor, PropertyID_Goal, tick + 1);
+        Sync::Flush();
+        Sync::Poll(&Apply);
+    }
+    TEST_ASSERT_TRUE(Sync::Frames());
+    // the goals set meanwhile went to the Domain
+    TEST_ASSERT_NOT_EQUAL(0, VirtualBot.GetEntityPropertyValue(EntityID_LeftMotor, PropertyID_Goal));
+    Sync::UseFrames(false);
+    TEST_ASSERT_FALSE(Sync::Frames());
+}
+
+void test_frames_against_messages()
+{
+    Session domain = Drive(false);
+    Session sync = Drive(true);
+
+    float seconds = sessionTicks * tickMsec / 1000.0f;
+    char buf[120];
+    snprintf(buf, sizeof(buf), "Domain: %u sets, %.1f messages/sec", domain.sets, domain.messages / seconds);
+    TEST_MESSAGE(buf);
+    snprintf(buf, sizeof(buf), "Sync: %u sets, %.1f frames/sec, %.2f bytes/update, %.1f updates/frame",
+        sync.sets, sync.frames / seconds, (float)sync.bytes / sync.updates, (float)sync.updates / sync.frames);
+    TEST_MESSAGE(buf);
+
+    // the Domain is handed every coalesced change, one message each unless it already had the value
+    TEST_ASSERT_LESS_OR_EQUAL(domain.updates, domain.messages);
+    TEST_ASSERT_GREATER_THAN(domain.updates * 9 / 10, domain.messages);
+    TEST_ASSERT_EQUAL_UINT32(0, domain.frames);
+    // all the changes of a tick share a frame, with the clock exchanges and keyframes on top
+    TEST_ASSERT_GREATER_OR_EQUAL(domain.messages, sync.updates);
+    TEST_ASSERT_LESS_THAN(domain.messages / 2, sync.frames);
+    TEST_ASSERT_LESS_OR_EQUAL(sessionTicks + sessionTicks * tickMsec / Sync::keyframeInterval + 12, sync.frames);
+    // a goal record is 3 bytes, with the frame headers and clock exchanges shared out
+    TEST_ASSERT_LESS_THAN(8, sync.bytes / sync.updates);
+}
+
+void test_loopback_setpoints()
+{
+    VirtualBot.Link(&RobotBot);
+    RobotBot.Link(&VirtualBot);
+    Sync::Subscribe(motorSubs, sizeof(motorSubs) / sizeof(Subscription));
+    Loopback domain = Setpoints(false);
+    TEST_ASSERT_EQUAL_INT16(domain.goal, rpm);
+    Loopback sync = Setpoints(true);
+    TEST_ASSERT_TRUE(Sync::Frames());
+    TEST_ASSERT_EQUAL_INT16(sync.goal, rpm);
+
+    char buf[120];
+    snprintf(buf, sizeof(buf), "Domain: %.2f messages/setpoint, %u echoes", (float)domain.sent / setpoints, domain.echoes);
+    TEST_MESSAGE(buf);
+    snprintf(buf, sizeof(buf), "Sync: %.2f frames/setpoint, %u echoes", (float)sync.sent / setpoints, sync.echoes);
+    TEST_MESSAGE(buf);
+
+    // the goal out and back, the RPM in and back
+    TEST_ASSERT_EQUAL_UINT32(4 * setpoints, domain.sent);
+    TEST_ASSERT_EQUAL_UINT32(setpoints, domain.echoes);
+    // the goal out and the RPM in, with the clock exchanges and keyframes on top, the goal never sent back
+    TEST_ASSERT_LESS_THAN(3 * setpoints, sync.sent);
+    TEST_ASSERT_EQUAL_UINT32(0, sync.echoes);
+}
+
+void test_idle_keyframes()
+{
+    // the robot is brought back in step with nothing set, should it have restarted
+    Sync::UseFrames(true);
+    const Sync::Stats& stats = Sync::GetStats();
+    uint32_t keyframes = stats.keyframes;
+    uint32_t sets = stats.sets;
+    for (int tick = 0; tick < 5 * Sync::keyframeInterval / tickMsec; tick++)
+    {
+        Host::Advance(tickMsec * 1000);
+        Sync::Flush();
+        Sync::Poll(&Apply);
+    }
+    TEST_ASSERT_EQUAL_UINT32(sets, stats.sets);
+    TEST_ASSERT_UINT32_WITHIN(1, 5, stats.keyframes - keyframes);
+}
+
+/**
+ * @brief Run the clock exchanges with the peer's clock running at a drift, checking the estimates at the end
+ */
+void CheckClock(int32_t drift)
+{
+    SimPeer::SetDrift(drift);
+    for (uint32_t tick = 0; tick < clockSeconds * 1000UL / tickMsec; tick++)
+    {
+        Host::Advance(tickMsec * 1000);
+        Sync::Flush();
+        Sync::Poll(&Apply);
+    }
+    const Sync::Clock& clock = Sync::GetClock();
+    SimPeer::Truth truth = SimPeer::GetTruth();
+
+    char buf[120];
+    snprintf(buf, sizeof(buf), "Sync: offset %+d us drift %d ppb up %u us down %u us after %u exchanges",
+        clock.offset - truth.offset, clock.drift, clock.up, clock.down, clock.exchanges);
+    TEST_MESSAGE(buf);
+    snprintf(buf, sizeof(buf), "Sim: drift %d ppb up %u us down %u us", truth.drift, truth.up, truth.down);
+    TEST_MESSAGE(buf);
+
+    TEST_ASSERT_TRUE(clock.valid);
+    // the offset from the fastest exchange is off by half the difference of its legs
+    TEST_ASSERT_INT32_WITHIN(2000, truth.offset, clock.offset);
+    // the legs carry the offset error, one each way
+    TEST_ASSERT_INT32_WITHIN(1000, truth.up, clock.up);
+    TEST_ASSERT_INT32_WITHIN(1000, truth.down, clock.down);
+    // the fit over the four minutes of windows, all at this drift
+    TEST_ASSERT_INT32_WITHIN(3000, truth.drift, clock.drift);
+}
+
+void test_clock_estimates()
+{
+    // the same jitter every run
+    randomSeed(1);
+    Sync::UseFrames(true);
+    uint32_t exchanges = Sync::GetClock().exchanges;
+    CheckClock(SimPeer::driftPpb);
+    TEST_ASSERT_GREATER_OR_EQUAL(clockSeconds * 1000UL / Sync::clockInterval - 1, Sync::GetClock().exchanges - exchanges);
+    // running slow instead, so a sign error shows
+    CheckClock(-SimPeer::driftPpb);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_varint_zigzag);
+    RUN_TEST(test_frames_offered);
+    RUN_TEST(test_frames_against_messages);
+    RUN_TEST(test_loopback_setpoints);
+    RUN_TEST(test_idle_keyframes);
+    RUN_TEST(test_clock_estimates);
+    return UNITY_END();
+}
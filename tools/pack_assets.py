@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Pack the UI images (images/*.bmp) into one compressed asset blob (see include/Assets.h).
+
+    pack_assets.py                          # images/ to assets/ui.bin
+    pack_assets.py IMAGES OUT --list        # and show the sizes
+
+Also runs as a PlatformIO pre: extra script, rebuilding assets/ui.bin when
+any image is newer, before the blob is embedded in the firmware.
+Only uncompressed 24-bit and 32-bit BMPs are read, no imaging library is needed.
+"""
+import argparse
+import glob
+import os
+import struct
+import sys
+
+MAGIC = 0x31415850      # 'PXA1'
+HEADER = struct.Struct('<IHH')
+ENTRY = struct.Struct('<12sHHII')
+NAME_MAX = 11
+RUN_MIN = 2
+RUN_MAX = 129
+LITERAL_MAX = 128
+
+
+def read_bmp(path):
+    """Read a BMP file, returning (width, height, RGB565 pixels top row first)."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:2] != b'BM':
+        raise ValueError('%s: not a BMP' % path)
+    offset, = struct.unpack_from('<I', data, 10)
+    width, height, planes, bpp, compression = struct.unpack_from('<iiHHI', data, 18)
+    if bpp not in (24, 32) or compression not in (0, 3):
+        raise ValueError('%s: %d bpp compression %d is not supported' % (path, bpp, compression))
+    flip = height > 0
+    height = abs(height)
+    step = bpp // 8
+    stride = (width * step + 3) & ~3
+    pixels = []
+    for y in range(height):
+        row = offset + (height - 1 - y if flip else y) * stride
+        for x in range(width):
+            b, g, r = data[row + x * step:row + x * step + 3]
+            pixels.append(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    return width, height, pixels
+
+
+def rle(pixels):
+    """Compress RGB565 pixels: a control byte below 0x80 is followed by
+    control+1 literal pixels, otherwise the one pixel following repeats
+    control-0x80+2 times."""
+    out = bytearray()
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:LITERAL_MAX]
+            del literal[:LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            out.extend(struct.pack('<%dH' % len(chunk), *chunk))
+
+    i = 0
+    n = len(pixels)
+    while i < n:
+        run = 1
+        while i + run < n and run < RUN_MAX and pixels[i + run] == pixels[i]:
+            run += 1
+        if run >= RUN_MIN:
+            flush()
+            out.append(0x80 + run - RUN_MIN)
+            out.extend(struct.pack('<H', pixels[i]))
+        else:
+            literal.append(pixels[i])
+        i += run
+    flush()
+    return bytes(out)
+
+
+def pack(images, out, listing=False):
+    """Pack every BMP in the images directory into the blob at out."""
+    paths = sorted(glob.glob(os.path.join(images, '*.bmp')))
+    entries = []
+    blobs = []
+    offset = HEADER.size + ENTRY.size * len(paths)
+    raw = 0
+    for path in paths:
+        name = os.path.splitext(os.path.basename(path))[0].lower()
+        if len(name) > NAME_MAX:
+            raise ValueError('%s: name longer than %d' % (path, NAME_MAX))
+        width, height, pixels = read_bmp(path)
+        data = rle(pixels)
+        entries.append(ENTRY.pack(name.encode(), width, height, offset, len(data)))
+        blobs.append(data)
+        offset += len(data)
+        raw += len(pixels) * 2
+        if listing:
+            print('%-12s %3dx%-3d %7d -> %6d' % (name, width, height, len(pixels) * 2, len(data)))
+    os.makedirs(os.path.dirname(out) or '.', exist_ok=True)
+    with open(out, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, len(entries), 0))
+        for e in entries:
+            f.write(e)
+        for b in blobs:
+            f.write(b)
+    if listing:
+        print('%d images, %d bytes of pixels packed in %d bytes' % (len(paths), raw, offset))
+
+
+def stale(images, out):
+    """Determine if the blob is missing or older than any image."""
+    if not os.path.exists(out):
+        return True
+    built = os.path.getmtime(out)
+    return any(os.path.getmtime(p) > built for p in glob.glob(os.path.join(images, '*.bmp')))
+
+
+try:
+    Import('env')   # noqa: F821 - provided when run by PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    project = env.subst('$PROJECT_DIR')
+    images = os.path.join(project, 'images')
+    out = os.path.join(project, 'assets', 'ui.bin')
+    if stale(images, out):
+        print('Packing UI assets')
+        pack(images, out, listing=True)
+elif __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser.add_argument('images', nargs='?', default=os.path.join(root, 'images'))
+    parser.add_argument('out', nargs='?', default=os.path.join(root, 'assets', 'ui.bin'))
+    parser.add_argument('--list', action='store_true', help='show the size of each image')
+    args = parser.parse_args()
+    try:
+        pack(args.images, args.out, args.list)
+    except ValueError as e:
+        sys.exit(str(e))
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+Decode the PSXPad binary trace stream (see include/Trace.h) to Teleplot or CSV.
+
+    trace_decode.py COM5                    # Teleplot lines to stdout
+    trace_decode.py COM5 --udp              # straight to the Teleplot VS Code extension
+    trace_decode.py COM5 --csv > run.csv
+    trace_decode.py capture.bin --csv       # decode a saved capture
+
+Opening a serial port sends 'b' to start streaming and 't' to stop when done.
+Requires pyserial for serial ports.
+"""
+import argparse
+import os
+import socket
+import struct
+import sys
+
+SYNC = b'\xA5\x5A'
+RECORD = struct.Struct('<IBBBh')
+
+KINDS = ('prop', 'stage', 'pad')
+STAGES = ('Touch', 'Pad', 'Sync', 'History', 'Changes', 'Trace', 'Loop')
+PADKEYS = ('Select', 'L3', 'R3', 'Start', 'Up', 'Right', 'Down', 'Left',
+           'L2', 'R2', 'L1', 'R1', 'Triangle', 'Circle', 'Cross', 'Square',
+           'Analog', 'LeftStick', 'RightStick',
+           'Knob0Btn', 'Knob1Btn', 'Knob2Btn', 'Knob3Btn',
+           'Knob0', 'Knob1', 'Knob2', 'Knob3')
+
+
+def name(kind, a, b):
+    """Name a trace channel."""
+    if kind == 0:
+        return 'E%d.P%d' % (a, b)
+    if kind == 1:
+        return 'stage.' + (STAGES[a] if a < len(STAGES) else str(a))
+    key = PADKEYS[a] if a < len(PADKEYS) else str(a)
+    return 'pad.%s%s' % (key, '.y' if b else '')
+
+
+def frames(read):
+    """Yield the decoded records of each valid frame from a read(n) function."""
+    buf = b''
+    while True:
+        data = read(4096)
+        if not data:
+            return
+        buf += data
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                buf = buf[-1:]
+                break
+            if len(buf) < i + 3:
+                buf = buf[i:]
+                break
+            n = buf[i + 2]
+            end = i + 3 + n * RECORD.size + 1
+            if len(buf) < end:
+                buf = buf[i:]
+                break
+            body = buf[i + 3:end - 1]
+            check = 0
+            for c in body:
+                check ^= c
+            if check != buf[end - 1]:
+                # not a real frame, resync past this sync pattern
+                buf = buf[i + 1:]
+                continue
+            yield [RECORD.unpack_from(body, k * RECORD.size) for k in range(n)]
+            buf = buf[end:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('source', help='serial port or capture file')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--csv', action='store_true', help='write CSV rather than Teleplot lines')
+    parser.add_argument('--udp', action='store_true', help='send Teleplot lines to localhost:47269')
+    args = parser.parse_args()
+
+    port = None
+    if os.path.isfile(args.source):
+        stream = open(args.source, 'rb')
+        read = stream.read
+    else:
+        import serial
+        port = serial.Serial(args.source, args.baud, timeout=0.1)
+        port.write(b'b')
+
+        def read(n):
+            # wait for data, a serial stream only ends when interrupted
+            while True:
+                data = port.read(min(n, max(1, port.in_waiting)))
+                if data:
+                    return data
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM) if args.udp else None
+    out = sys.stdout
+    if args.csv:
+        out.write('usec,kind,channel,value\n')
+    try:
+        for records in frames(read):
+            for usec, kind, a, b, value in records:
+                channel = name(kind, a, b)
+                if args.csv:
+                    out.write('%d,%s,%s,%d\n' % (usec, KINDS[kind] if kind < len(KINDS) else kind, channel, value))
+                else:
+                    line = '>%s:%.3f:%d\n' % (channel, usec / 1000.0, value)
+                    if sock:
+                        sock.sendto(line.encode(), ('127.0.0.1', 47269))
+                    else:
+                        out.write(line)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port:
+            port.write(b't')
+            port.close()
+
+
+if __name__ == '__main__':
+    main()